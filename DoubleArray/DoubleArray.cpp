@@ -1,13 +1,38 @@
 #include "DoubleArray.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <thread>
+#include <atomic>
+#include <string>
 
 using namespace std;
 
+#ifdef DA_ENABLE_LOOKUP_COUNTERS
+/* 検索Counter 全DoubleArrayで共有する */
+static atomic<uint64_t> i_lookup_searches(0);
+static atomic<uint64_t> i_lookup_transitions(0);
+static atomic<uint64_t> i_lookup_tail_compares(0);
+static atomic<uint64_t> i_lookup_misses(0);
+static atomic<uint64_t> i_lookup_miss_depths[DALookupCounters::I_DEPTH_MAX];
+#endif
+
 /* init only */
-DoubleArray::DoubleArray() : i_base_(nullptr), i_check_(nullptr), c_tail_(nullptr), i_result_(nullptr),
+DoubleArray::DoubleArray() : i_base_(nullptr), i_check_(nullptr), c_tail_(nullptr), i_result_(nullptr), units_(nullptr),
+                             reverse_index_(nullptr), i_reverse_size_(0), scan_states_(nullptr),
+                             result_blocks_(nullptr), i_packed_result_(nullptr), i_packed_size_(0),
                              i_array_size_(I_DEFAULT_ARRAY_SIZE),
                              i_tail_size_(I_DEFAULT_ARRAY_SIZE),
-                             i_result_size_(I_DEFAULT_ARRAY_SIZE)
+                             i_result_size_(I_DEFAULT_ARRAY_SIZE),
+                             i_option_(I_NO_OPTION), p_mapped_(nullptr), i_mapped_size_(0),
+                             i_tail_used_(0), i_free_index_(1), i_free_end_(0),
+                             i_base_check_extends_(0), i_tail_extends_(0), i_build_times_{0}
 {
+  for (int i = 0; i < 256; ++i) {
+    c_code_table_[i] = static_cast<unsigned char>(i);
+    c_code_bytes_[i] = static_cast<unsigned char>(i);
+  }
 }
 
 
@@ -27,15 +52,20 @@ int DoubleArray::keepMemory(
   deleteMemory(b_init_size);  /* 既存のデータ構造を破棄 */
 
   try {
-    i_base_  = new int[i_array_size_];
-    i_check_ = new int[i_array_size_];
+    if (i_option_ & I_UNIT_LAYOUT) {
+      units_ = new DAUnit[i_array_size_];
+      memset(units_, 0, sizeof(units_[0]) * i_array_size_);
+    } else {
+      i_base_  = new int[i_array_size_];
+      i_check_ = new int[i_array_size_];
+      memset(i_base_,  0,               sizeof(i_base_[0])  * i_array_size_);
+      memset(i_check_, I_ARRAY_NO_DATA, sizeof(i_check_[0]) * i_array_size_);
+    }
     c_tail_  = new char[i_tail_size_];
     if (i_result_size_) {
       i_result_ = new int64_t[i_result_size_];
     }
 
-    memset(i_base_,  0,               sizeof(i_base_[0])  * i_array_size_);
-    memset(i_check_, I_ARRAY_NO_DATA, sizeof(i_check_[0]) * i_array_size_);
     memset(c_tail_,  0,               sizeof(c_tail_[0])  * i_tail_size_);
     if (i_result_size_) {
       memset(i_result_, 0, sizeof(i_result_[0]) * i_result_size_);
@@ -54,15 +84,40 @@ int DoubleArray::keepMemory(
 void DoubleArray::deleteMemory(
   const bool b_init_size) noexcept
 {
-  if (i_base_)   delete[] i_base_;
-  if (i_check_)  delete[] i_check_;
-  if (c_tail_)   delete[] c_tail_;
-  if (i_result_) delete[] i_result_;
+  deleteReverseIndex();
+  deleteScanTable();
+  if (p_mapped_) {  /* mmap領域を参照しているだけなので解放しない */
+    munmap(p_mapped_, i_mapped_size_);
+    p_mapped_      = nullptr;
+    i_mapped_size_ = 0;
+  } else {
+    if (i_base_)   delete[] i_base_;
+    if (i_check_)  delete[] i_check_;
+    if (c_tail_)   delete[] c_tail_;
+    if (i_result_) delete[] i_result_;
+    if (units_)    delete[] units_;
+    if (result_blocks_)   delete[] result_blocks_;
+    if (i_packed_result_) delete[] i_packed_result_;
+  }
 
   i_base_   = nullptr;
   i_check_  = nullptr;
   c_tail_   = nullptr;
   i_result_ = nullptr;
+  units_    = nullptr;
+
+  result_blocks_   = nullptr;
+  i_packed_result_ = nullptr;
+  i_packed_size_   = 0;
+
+  for (int i = 0; i < 256; ++i) {  /* Code表は恒等に戻す */
+    c_code_table_[i] = static_cast<unsigned char>(i);
+    c_code_bytes_[i] = static_cast<unsigned char>(i);
+  }
+
+  i_tail_used_  = 0;
+  i_free_index_ = 1;
+  i_free_end_   = 0;
 
   if (b_init_size) {
     i_array_size_  = I_DEFAULT_ARRAY_SIZE;
@@ -76,7 +131,81 @@ void DoubleArray::deleteMemory(
 /* @return true : データ作成されてる  false : 空 */
 bool DoubleArray::checkInit() const noexcept
 {
-  return i_base_ != nullptr;
+  return (i_base_ != nullptr || units_ != nullptr);
+}
+
+
+/* Base値を取得する              */
+/* @param i_index BaseCheckIndex */
+/* @return Base値                */
+inline int DoubleArray::getBase(
+  const int i_index) const noexcept
+{
+  return (units_ ? units_[i_index].i_base_ : i_base_[i_index]);
+}
+
+
+/* Check値を取得する             */
+/* @param i_index BaseCheckIndex */
+/* @return Check値               */
+inline int DoubleArray::getCheck(
+  const int i_index) const noexcept
+{
+  return (units_ ? units_[i_index].i_check_ : i_check_[i_index]);
+}
+
+
+/* Base/Checkを先読みする        */
+/* @param i_index BaseCheckIndex */
+inline void DoubleArray::prefetchNode(
+  const int i_index) const noexcept
+{
+  if (units_) {
+    __builtin_prefetch(&units_[i_index]);
+  } else {
+    __builtin_prefetch(&i_check_[i_index]);
+    __builtin_prefetch(&i_base_[i_index]);
+  }
+}
+
+
+/* Byteを遷移に使うCodeに変換する */
+/* @param c_byte 変換するByte     */
+/* @return 遷移Code               */
+inline int DoubleArray::getCode(
+  const char c_byte) const noexcept
+{
+  return c_code_table_[static_cast<unsigned char>(c_byte)];
+}
+
+
+/* searchの経過を検索Counterに加える           */
+/* @param i_transitions 試したBase/Check遷移数 */
+/* @param b_tail        Tailを比較したか       */
+/* @param b_miss        該当無しか             */
+/* @param i_depth       遷移を終えたByte位置   */
+inline void DoubleArray::countLookup(
+  const uint64_t i_transitions,
+  const bool b_tail,
+  const bool b_miss,
+  const uint64_t i_depth) noexcept
+{
+#ifdef DA_ENABLE_LOOKUP_COUNTERS
+  i_lookup_searches.fetch_add(1, memory_order_relaxed);
+  i_lookup_transitions.fetch_add(i_transitions, memory_order_relaxed);
+  if (b_tail) {
+    i_lookup_tail_compares.fetch_add(1, memory_order_relaxed);
+  }
+  if (b_miss) {
+    i_lookup_misses.fetch_add(1, memory_order_relaxed);
+    i_lookup_miss_depths[min(i_depth, DALookupCounters::I_DEPTH_MAX - 1)].fetch_add(1, memory_order_relaxed);
+  }
+#else
+  (void)i_transitions;
+  (void)b_tail;
+  (void)b_miss;
+  (void)i_depth;
+#endif
 }
 
 
@@ -104,6 +233,7 @@ int DoubleArray::baseCheckExtendMemory(
     i_base_       = i_new_base;
     i_check_      = i_new_check;
     i_array_size_ = i_new_array_size;
+    ++i_base_check_extends_;
   } catch (...) {
     deleteMemory();
     return I_FAILED_MEMORY;
@@ -125,19 +255,22 @@ int DoubleArray::tailExtendMemory(
       i_new_tail_size *= I_EXTEND_MEMORY;
     } while (i_new_tail_size < i_lower_limit);
 
-    char* c_tail      = new char[i_new_tail_size];
-    int64_t* i_result = new int64_t[i_new_tail_size];
-    memset(c_tail,   0,         sizeof(c_tail[0])   * i_new_tail_size);
-    memset(i_result, 0,         sizeof(i_result[0]) * i_new_tail_size);
-    memcpy(c_tail,   c_tail_,   sizeof(c_tail[0])   * i_tail_size_);
-    memcpy(i_result, i_result_, sizeof(i_result[0]) * i_result_size_);
-
+    char* c_tail = new char[i_new_tail_size];
+    memset(c_tail, 0,       sizeof(c_tail[0]) * i_new_tail_size);
+    memcpy(c_tail, c_tail_, sizeof(c_tail[0]) * i_tail_size_);
     delete[] c_tail_;
-    delete[] i_result_;
-    c_tail_        = c_tail;
-    i_result_      = i_result;
-    i_tail_size_   = i_new_tail_size;
-    i_result_size_ = i_new_tail_size;
+    c_tail_      = c_tail;
+    i_tail_size_ = i_new_tail_size;
+    ++i_tail_extends_;
+
+    if (i_result_) {  /* I_TAIL_UNITYで結果を破棄した後は確保しない */
+      int64_t* i_result = new int64_t[i_new_tail_size];
+      memset(i_result, 0,         sizeof(i_result[0]) * i_new_tail_size);
+      memcpy(i_result, i_result_, sizeof(i_result[0]) * i_result_size_);
+      delete[] i_result_;
+      i_result_      = i_result;
+      i_result_size_ = i_new_tail_size;
+    }
   } catch (...) {
     deleteMemory();
     return I_FAILED_MEMORY;
@@ -156,6 +289,7 @@ int DoubleArray::optimizeMemory(
   if (i_array_size_ == 0)
     return I_NO_ERROR;
 
+  const uint64_t i_old_array_size(i_array_size_);
   for (int64_t i = i_array_size_ - 1; i >= 0; --i) {
     if (i_base_[i]) {
       i_array_size_ = i + 1;
@@ -168,10 +302,13 @@ int DoubleArray::optimizeMemory(
 
   try {
     /* 配列情報 */
+    const uint64_t i_copy_size(min(i_old_array_size, i_array_size_));  /* 末尾の余白は確保済みとは限らない */
     int* i_new_base  = new int[i_array_size_];
     int* i_new_check = new int[i_array_size_];
-    memcpy(i_new_base,  i_base_,  sizeof(i_new_base[0])  * i_array_size_);
-    memcpy(i_new_check, i_check_, sizeof(i_new_check[0]) * i_array_size_);
+    memset(i_new_base,  0,               sizeof(i_new_base[0])  * i_array_size_);
+    memset(i_new_check, I_ARRAY_NO_DATA, sizeof(i_new_check[0]) * i_array_size_);
+    memcpy(i_new_base,  i_base_,  sizeof(i_new_base[0])  * i_copy_size);
+    memcpy(i_new_check, i_check_, sizeof(i_new_check[0]) * i_copy_size);
     delete[] i_base_;
     delete[] i_check_;
     i_base_  = i_new_base;
@@ -206,599 +343,3827 @@ int DoubleArray::optimizeMemory(
 int DoubleArray::createDoubleArray(
   ByteArrays& add_datas,
   const int i_option) noexcept
+{
+  return createDoubleArray(add_datas, i_option, 1);
+}
+
+
+/* 複数Threadで並列にDoubleArrayを構築する     */
+/* @param add_datas      DoubleArray構築データ */
+/* @param i_option       構築オプション        */
+/* @param i_thread_count Thread数              */
+/* @return 0 : 正常終了  0以外 : 異常終了      */
+int DoubleArray::createDoubleArray(
+  ByteArrays& add_datas,
+  const int i_option,
+  const unsigned int i_thread_count) noexcept
 {
   if (add_datas.empty())
     return I_NO_ERROR;
 
-  add_datas.sort(); /* Sort */
-
-  /* Trie構築 */
-  TrieNode* root_node = nullptr;
-  createTrie(root_node, add_datas);
-  if (keepMemory(true)) { /* メモリ確保 */
-    return I_FAILED_MEMORY;
+  resetBuildStats();
+  unsigned char c_code_table[256], c_code_bytes[256];
+  if (i_option & I_CODE_TABLE) {  /* Codeに置き換えたデータで構築する */
+    createCodeTable(c_code_table, c_code_bytes, add_datas);
+    encodeByteArrays(add_datas, c_code_table);
   }
 
-  /* DoubleArray構築 */
-  unsigned int base_array[256] = { 1 }; /* 分岐するNodeのBaseで全ての分岐先に適応する値を探すのに使用 */
-  int i_tail_index(1), i_base_index(0); /* BaseとTailの初期値 */
-  if (recursiveCreateDoubleArray(i_tail_index, base_array, root_node, i_base_index)) {
-    return I_FAILED_MEMORY;
+  int i_tail_index;
+  int i_error(createParallelDoubleArray(i_tail_index, add_datas, i_thread_count));
+  if (i_option & I_CODE_TABLE) {
+    encodeByteArrays(add_datas, c_code_bytes);  /* 構築データを元に戻す */
+    if (i_error == I_NO_ERROR) {
+      setCodeTable(c_code_table, c_code_bytes, i_tail_index);
+    }
   }
-
-  if (i_option & I_TAIL_UNITY) {
-    delete[] i_result_;
-    i_result_      = nullptr;
-    i_result_size_ = 0;
+  if (i_error) {
+    return i_error;
   }
 
-  return optimizeMemory(i_tail_index);
+  const auto optimize_start(chrono::steady_clock::now());
+  i_error = completeDoubleArray(i_tail_index, i_option);
+  i_build_times_[I_PHASE_OPTIMIZE] += getElapsedTime(optimize_start);
+
+  return i_error;
 }
 
 
-/* 入力データからTRIE構造を構築する          */
-/* @param root_node   構築したTrie Root Node */
-/* @param byte_arrays 基にするデータ         */
-void DoubleArray::createTrie(
-  TrieNode*& root_node,
-  const ByteArrays& byte_arrays) const noexcept
+/* 全データ共通の接頭辞の次のByte毎に部分DoubleArrayを並列に構築してまとめる */
+/* @param i_tail_index   Tail配列のデータが格納されている最終Index           */
+/* @param add_datas      DoubleArray構築データ                               */
+/* @param i_thread_count Thread数                                            */
+/* @return Error Code                                                        */
+int DoubleArray::createParallelDoubleArray(
+  int& i_tail_index,
+  ByteArrays& add_datas,
+  const unsigned int i_thread_count) noexcept
 {
-  uint64_t i_max_length;
-  vector<pair<uint64_t, uint64_t>> positions(byte_arrays.size(), make_pair(0, 0)); /* TailPosition */
-  createOverlapPositions(i_max_length, positions, byte_arrays); /* TailPositionデータ作成 */
+  const unsigned int i_threads(i_thread_count ? i_thread_count : max(thread::hardware_concurrency(), 1u));
+  const auto sort_start(chrono::steady_clock::now());
+  add_datas.sort(i_threads); /* Sort */
+  i_build_times_[I_PHASE_SORT] += getElapsedTime(sort_start);
 
-  vector<TrieNode*> trie_nodes(i_max_length, nullptr);
-  constexpr uint64_t i_max_value = numeric_limits<uint64_t>::max();
-  auto position = positions.cbegin();
-  for (const auto& byte_array : byte_arrays) {
-    const auto i_start(position->first);
-    const auto i_tail(position->second);
-    ++position;
-    if (i_start == i_max_value) /* データが重複かチェック */
-      continue;
+  /* 全データ共通の接頭辞 その直後のByteで分割する */
+  const ByteArray* datas(add_datas.data());
+  const auto& front = add_datas.front();
+  const auto& back  = add_datas.back();
+  const uint64_t i_low_size(min(front.i_byte_length_, back.i_byte_length_));
+  uint64_t i_prefix_length(0);
+  while ((i_prefix_length < i_low_size) && (front.c_byte_[i_prefix_length] == back.c_byte_[i_prefix_length])) {
+    ++i_prefix_length;
+  }
 
-    char* c_tail(nullptr);
-    int64_t i_tail_size(0);
-    if (i_tail < byte_array.i_byte_length_ - 1) {
-      i_tail_size = byte_array.i_byte_length_ - i_tail - 1;
-      c_tail = new char[i_tail_size];
-      memcpy(c_tail, (byte_array.c_byte_ + i_tail + 1), i_tail_size);
+  if ((i_threads <= 1) || (i_prefix_length == i_low_size)) { /* 分割できない */
+    if (createSortedDoubleArray(i_tail_index, datas, add_datas.size())) {
+      return I_FAILED_MEMORY;
     }
+    return I_NO_ERROR;
+  }
 
-    auto branch_node = trie_nodes[i_start];
-    auto node_parts  = new NodeParts(c_tail, i_tail_size, byte_array.result_);
-    auto next_node   = new TrieNode(byte_array.c_byte_[i_tail], nullptr, nullptr, node_parts);
-    trie_nodes[i_tail] = next_node;
+  vector<DASubArray> sub_arrays;
+  vector<int> sub_order;  /* 部分構築するByte データ数の多い順 */
+  try {
+    sub_arrays.resize(256);
+    for (uint64_t i = 0, i_count = add_datas.size(); i < i_count; ) {
+      auto& sub_array = sub_arrays[static_cast<unsigned char>(datas[i].c_byte_[i_prefix_length])];
+      sub_array.i_begin_ = i;
+      while ((++i < i_count) && (datas[i].c_byte_[i_prefix_length] == datas[sub_array.i_begin_].c_byte_[i_prefix_length]));
+      sub_array.i_end_ = i;
 
-    for (int64_t i = i_tail - 1; i >= static_cast<int64_t>(i_start); --i) {
-      trie_nodes[i] = next_node = new TrieNode(byte_array.c_byte_[i], nullptr, next_node, nullptr);
+      const auto& first = datas[sub_array.i_begin_];
+      const auto& last  = datas[sub_array.i_end_ - 1];
+      sub_array.b_single_ = ((first.i_byte_length_ == last.i_byte_length_)
+                          && (memcmp(first.c_byte_, last.c_byte_, first.i_byte_length_) == 0));
+      if (!sub_array.b_single_) {
+        sub_order.push_back(static_cast<unsigned char>(first.c_byte_[i_prefix_length]));
+      }
     }
+  } catch (...) {
+    return I_FAILED_MEMORY;
+  }
+  sort(sub_order.begin(), sub_order.end(), [&sub_arrays](const int i_first, const int i_second) {
+    return (sub_arrays[i_first].i_end_ - sub_arrays[i_first].i_begin_) > (sub_arrays[i_second].i_end_ - sub_arrays[i_second].i_begin_);});
 
-    if (root_node == nullptr) {
-      root_node = trie_nodes[i_start];
+  /* 各Threadが空いた順に部分DoubleArrayを構築する */
+  atomic<uint64_t> i_next_order(0);
+  auto createSubArrays = [&]() {
+    for (uint64_t i = i_next_order++; i < sub_order.size(); i = i_next_order++) {
+      auto& sub_array = sub_arrays[sub_order[i]];
+      sub_array.i_error_ = sub_array.double_array_.createSortedDoubleArray(
+        sub_array.i_tail_index_, datas + sub_array.i_begin_, sub_array.i_end_ - sub_array.i_begin_);
     }
+  };
 
-    if (branch_node != nullptr) {
-      branch_node->p_same_layer_ = trie_nodes[i_start];
+  vector<thread> threads;
+  try {
+    for (unsigned int i = 1; i < min<uint64_t>(i_threads, sub_order.size()); ++i) {
+      threads.emplace_back(createSubArrays);
     }
+  } catch (...) {
+    /* 起動できた分だけで構築する */
+  }
+  createSubArrays();
+  for (auto& sub_thread : threads) {
+    sub_thread.join();
   }
+
+  for (const auto& sub_array : sub_arrays) {
+    if (sub_array.i_error_)
+      return sub_array.i_error_;
+  }
+
+  const auto merge_start(chrono::steady_clock::now());
+  if (mergeDoubleArrays(i_tail_index, datas, i_prefix_length, sub_arrays)) {
+    return I_FAILED_MEMORY;
+  }
+  i_build_times_[I_PHASE_LAYOUT] += getElapsedTime(merge_start);
+
+  return I_NO_ERROR;
 }
 
 
-/* @param i_tail_index 書き込み開始TailIndex           */
-/* @param base_array   BaseValueの値を決定するのに使用 */
-/* @param trie_node    Current TrieNode                */
-/* @param i_base_index 基準のBaseCheckIndex            */
-/* @return Error Code                                  */
-int DoubleArray::recursiveCreateDoubleArray(
-  int& i_tail_index,
-  unsigned int* base_array,
-  TrieNode* trie_node,
-  const int i_base_index) noexcept
+/* 構築データのByteの出現頻度からCode表を作成する */
+/* @param c_code_table Byte→Codeの表              */
+/* @param c_code_bytes Code→Byteの表              */
+/* @param add_datas    DoubleArray構築データ      */
+void DoubleArray::createCodeTable(
+  unsigned char* c_code_table,
+  unsigned char* c_code_bytes,
+  const ByteArrays& add_datas) noexcept
 {
-  unsigned int i_base_value;
-  if (getBaseValue(i_base_value, base_array, trie_node)) {
-    return I_FAILED_MEMORY; /* 構築失敗 */
+  uint64_t i_counts[256] = { 0 };
+  for (const auto& data : add_datas) {
+    for (uint64_t i = 0; i < data.i_byte_length_; ++i) {
+      ++i_counts[static_cast<unsigned char>(data.c_byte_[i])];
+    }
   }
-  i_base_[i_base_index] = i_base_value;
 
-  /* 再帰処理する前にcheckを設定 */
-  auto current_node = trie_node;
-  while (current_node != nullptr) {
-    i_check_[current_node->c_byte_ + i_base_value] = i_base_index;
-    current_node = current_node->p_same_layer_;
+  int i_bytes[255];  /* 終端記号以外のByte 出現数の多い順 */
+  for (int i = 0; i < 255; ++i) {
+    i_bytes[i] = i + 1;
   }
+  stable_sort(i_bytes, i_bytes + 255, [&i_counts](const int i_first, const int i_second) {
+    return i_counts[i_first] > i_counts[i_second];});
 
-  current_node = trie_node;
-  while (current_node != nullptr) {
-    int i_insert(current_node->c_byte_ + i_base_value);
-    if (current_node->node_parts_) {
-      i_base_[i_insert] = (-i_tail_index);  /* TailIndexはマイナス値 */
+  c_code_table[0] = C_TAIL_CHAR;  /* 終端記号 */
+  c_code_bytes[0] = C_TAIL_CHAR;
+  for (int i = 0; i < 255; ++i) {
+    c_code_table[i_bytes[i]] = static_cast<unsigned char>(i + 1);
+    c_code_bytes[i + 1]      = static_cast<unsigned char>(i_bytes[i]);
+  }
+}
 
-      if (setTailInfo(i_tail_index, current_node->node_parts_)) {
-        return I_FAILED_MEMORY; /* 構築失敗 */
-      }
-      delete current_node->node_parts_;
-    }
-    if (current_node->p_child_top_ != nullptr) {
-      if (recursiveCreateDoubleArray(i_tail_index, base_array, current_node->p_child_top_, i_insert)) {
-        return I_FAILED_MEMORY; /* 構築失敗 */
-      }
+
+/* 構築データのByteを表で置き換える          */
+/* @param add_datas    DoubleArray構築データ */
+/* @param c_code_table 置き換える表          */
+void DoubleArray::encodeByteArrays(
+  ByteArrays& add_datas,
+  const unsigned char* c_code_table) noexcept
+{
+  for (auto& data : add_datas) {
+    for (uint64_t i = 0; i < data.i_byte_length_; ++i) {
+      data.c_byte_[i] = static_cast<char>(c_code_table[static_cast<unsigned char>(data.c_byte_[i])]);
     }
-    auto delete_node = current_node;
-    current_node = current_node->p_same_layer_;
-    delete delete_node;
   }
-
-  return I_NO_ERROR;
 }
 
 
-/* Baseの値を求める ついでに同LayerLastIndexも求める    */
-/* @param i_base_value  求めたBase値                    */
-/* @param base_array    BaseValueの値を決定するのに使用 */
-/* @param trie_node     Current Trie Node               */
-/* @return Error Code                                   */
-int DoubleArray::getBaseValue(
-  unsigned int& i_base_value,
-  unsigned int* base_array,
-  const TrieNode* trie_node) noexcept
-{
-  /* 既存のバイト情報の最大Base値を検索 */
-  i_base_value = 0;
-
-  unsigned char c_byte_max(0x00);
-  auto current_node = trie_node;
-  do {
-    if (base_array[current_node->c_byte_] > i_base_value) {
-      i_base_value = base_array[current_node->c_byte_];
-    }
-    c_byte_max   = current_node->c_byte_;
-    current_node = current_node->p_same_layer_;
-  } while (current_node != nullptr);
-
-  ++i_base_value;
-  bool b_success(false);
-  do {
-    if (i_array_size_ <= (c_byte_max + i_base_value)) {
-      if (baseCheckExtendMemory(c_byte_max + i_base_value)) {
-        return I_FAILED_MEMORY;
-      }
-    }
+/* Codeで構築した後にCode表を設定し、TailをByteに戻す                 */
+/* @param c_code_table      Byte→Codeの表                             */
+/* @param c_code_bytes      Code→Byteの表                             */
+/* @param i_tail_last_index Tail配列のデータが格納されている最終Index */
+void DoubleArray::setCodeTable(
+  const unsigned char* c_code_table,
+  const unsigned char* c_code_bytes,
+  const int i_tail_last_index) noexcept
+{
+  memcpy(c_code_table_, c_code_table, sizeof(c_code_table_));
+  memcpy(c_code_bytes_, c_code_bytes, sizeof(c_code_bytes_));
+  for (int i = 0; i < i_tail_last_index; ++i) {
+    c_tail_[i] = static_cast<char>(c_code_bytes_[static_cast<unsigned char>(c_tail_[i])]);
+  }
 
-    uint64_t i_limit = i_array_size_ - c_byte_max;
-    do {
-      b_success = true;
-      current_node = trie_node;
-      while (current_node != nullptr) {
-        if (i_check_[current_node->c_byte_ + i_base_value] != I_ARRAY_NO_DATA) {
-          b_success = false;
-          break;
-        }
-        current_node = current_node->p_same_layer_;
-      }
-    } while (b_success == false && ++i_base_value < i_limit);
-  } while (b_success == false);
+  i_option_ |= I_CODE_TABLE;
+}
 
-  current_node = trie_node;
-  do {
-    base_array[current_node->c_byte_] = i_base_value;
-    current_node = current_node->p_same_layer_;
-  } while (current_node != nullptr);
 
-  return I_NO_ERROR;
+/* 読み込んだCode表が置換になっているか確認し、逆引きの表を作る */
+/* @return true : 正しいCode表                                  */
+bool DoubleArray::checkCodeTable() noexcept
+{
+  bool b_used[256] = { false };
+  for (int i = 0; i < 256; ++i) {
+    if (b_used[c_code_table_[i]])
+      return false;
+
+    b_used[c_code_table_[i]] = true;
+    c_code_bytes_[c_code_table_[i]] = static_cast<unsigned char>(i);
+  }
+
+  return (c_code_table_[0] == C_TAIL_CHAR);  /* 終端記号はCodeも0 */
 }
 
 
-/* Tailに情報を設定する                 */
-/* @param i_tail_index Tail格納開始位置 */
-/* @param node_parts   NodeParts        */
-/* @return Error code                   */
-int DoubleArray::setTailInfo(
+/* 整列済みデータからDoubleArrayを構築する     */
+/* @param i_tail_index 書き込んだ次のTailIndex */
+/* @param datas        構築データ 整列済み     */
+/* @param i_data_count データ数                */
+/* @return Error Code                          */
+int DoubleArray::createSortedDoubleArray(
   int& i_tail_index,
-  const NodeParts* node_parts) noexcept
+  const ByteArray* datas,
+  const uint64_t i_data_count) noexcept
 {
-  if ((i_tail_size_ <= i_tail_index + node_parts->i_tail_size_)
-  &&  (tailExtendMemory(i_tail_index + node_parts->i_tail_size_))) { /* メモリが不足したので拡張 */
+  /* Trie構築 */
+  TrieNode* root_node = nullptr;
+  DABuildArena arena; /* Trieは構築完了時にまとめて解放 */
+  uint64_t i_overlap_time(0);
+  const auto trie_start(chrono::steady_clock::now());
+  if (createTrie(root_node, arena, datas, i_data_count, i_overlap_time)) {
     return I_FAILED_MEMORY;
   }
+  i_build_times_[I_PHASE_OVERLAP] += i_overlap_time;
+  i_build_times_[I_PHASE_TRIE]    += getElapsedTime(trie_start) - i_overlap_time;
 
-  if (node_parts->c_tail_) {
-    memcpy(&c_tail_[i_tail_index], node_parts->c_tail_, node_parts->i_tail_size_);
-    i_tail_index += static_cast<int>(node_parts->i_tail_size_);
-    --i_tail_index;
-  } else {
-    c_tail_[i_tail_index] = C_TAIL_CHAR;
+  const auto layout_start(chrono::steady_clock::now());
+  i_option_ = I_NO_OPTION; /* 構築はBase/Check配列で行う */
+  if (keepMemory(true)) { /* メモリ確保 */
+    return I_FAILED_MEMORY;
   }
 
-  i_result_[i_tail_index++] = node_parts->i_result_;
+  /* DoubleArray構築 */
+  DAEmptySlots empty_slots; /* 分岐するNodeのBaseを空き要素から探すのに使用 */
+  empty_slots.openBlock(i_check_, i_array_size_);
+  empty_slots.use(0);  /* Root */
+  i_tail_index = 1; /* Tailの初期値 */
+  const int i_error(createDoubleArrayFromTrie(i_tail_index, empty_slots, root_node));
+  i_build_times_[I_PHASE_LAYOUT] += getElapsedTime(layout_start);
 
-  return I_NO_ERROR;
+  return i_error;
 }
 
 
-/* 重複Index情報作成                    */
-/* @param i_max_length 最長データ長     */
-/* @param positions    start,tail Index */
-/* @param datas        全追加データ     */
-void DoubleArray::createOverlapPositions(
-  uint64_t& i_max_length,
-  vector<pair<uint64_t, uint64_t>>& positions,
-  const ByteArrays& datas) const noexcept
+/* 部分DoubleArrayを再配置して1つにまとめる                    */
+/* Rootから共通接頭辞までを先頭に配置し、分岐Nodeの子の位置に  */
+/* 各部分の該当Nodeを置く。残りはIndexをずらして後ろに連結する */
+/* @param i_tail_index    書き込んだ次のTailIndex              */
+/* @param datas           構築データ 整列済み                  */
+/* @param i_prefix_length 全データ共通の接頭辞の長さ           */
+/* @param sub_arrays      先頭Byte毎の部分DoubleArray          */
+/* @return Error Code                                          */
+int DoubleArray::mergeDoubleArrays(
+  int& i_tail_index,
+  const ByteArray* datas,
+  const uint64_t i_prefix_length,
+  vector<DASubArray>& sub_arrays) noexcept
 {
-  if (datas.size() == 1) {
-    i_max_length = datas.front().i_byte_length_;
-    return;
+  const char* c_prefix(datas[0].c_byte_);
+
+  /* 共通接頭辞の各Nodeは次のNodeだけを子に持つので前から詰めて配置 */
+  uint64_t i_array_size(1);
+  for (uint64_t i = 0; i < i_prefix_length; ++i) {
+    i_array_size += static_cast<unsigned char>(c_prefix[i]) + 1;
   }
+  const uint64_t i_branch_base(i_array_size);  /* 分岐NodeのBase値 */
+  i_array_size += 256;
 
-  auto sameIndex = [](uint64_t& i_result, const uint64_t i_length, const char* c_first, const char* c_second) {
-    for (uint64_t i = 0; i < i_length; ++i) {
-      if (c_first[i] != c_second[i]) {
-        i_result = i;
-        break;
+  uint64_t i_tail_size(1);
+  vector<uint64_t> i_used_sizes(sub_arrays.size(), 0);
+  for (uint64_t i = 0; i < sub_arrays.size(); ++i) {
+    const auto& sub_array = sub_arrays[i];
+    if (sub_array.i_begin_ == sub_array.i_end_)
+      continue;
+
+    if (sub_array.b_single_) {
+      i_tail_size += max<uint64_t>(datas[sub_array.i_end_ - 1].i_byte_length_ - i_prefix_length - 1, 1);
+    } else {
+      const auto& double_array = sub_array.double_array_;
+      for (int64_t j = double_array.i_array_size_ - 1; j >= 0; --j) {
+        if (double_array.i_base_[j]) {
+          i_used_sizes[i] = j + 1;
+          break;
+        }
       }
+      i_array_size += i_used_sizes[i];
+      i_tail_size  += sub_array.i_tail_index_ - 1;
     }
-  };
+  }
 
-  /* 先頭 */
-  auto top  = datas.cbegin();
-  auto next = top;
-  ++next;
-  i_max_length = top->i_byte_length_;
-  uint64_t i_top_same_index(top->i_byte_length_);
-  sameIndex(i_top_same_index, top->i_byte_length_, top->c_byte_, next->c_byte_);
-  if (i_top_same_index == next->i_byte_length_) positions.begin()->first = numeric_limits<uint64_t>::max();
-  else                                          positions.begin()->second = i_top_same_index;
+  i_option_      = I_NO_OPTION;
+  i_array_size_  = i_array_size;
+  i_tail_size_   = i_tail_size + 1;
+  i_result_size_ = i_tail_size_;
+  if (keepMemory()) {
+    return I_FAILED_MEMORY;
+  }
 
-  /* 末尾 */
-  auto last    = datas.crbegin();
-  auto one_ago = last;
-  ++one_ago;
-  uint64_t i_last_same_index = 0;
-  sameIndex(i_last_same_index, min(last->i_byte_length_, one_ago->i_byte_length_), last->c_byte_, one_ago->c_byte_);
-  auto& last_position  = *positions.rbegin();
-  last_position.first  = i_last_same_index;
-  last_position.second = i_last_same_index;
-  if (i_max_length < last->i_byte_length_) {
-    i_max_length = last->i_byte_length_;
+  int i_branch_index(0);
+  i_base_[0] = 1;
+  for (uint64_t i = 0; i < i_prefix_length; ++i) {
+    const int i_insert(i_base_[i_branch_index] + static_cast<unsigned char>(c_prefix[i]));
+    i_check_[i_insert]     = i_branch_index;
+    i_base_[i_insert]      = i_insert + 1;
+    i_branch_index         = i_insert;
   }
+  i_base_[i_branch_index] = static_cast<int>(i_branch_base);
 
-  /* 先頭末尾を除く */
-  uint64_t i_before_same_index(i_top_same_index);
-  for (uint64_t i = 1, i_last = datas.size() - 1; i < i_last; ++i) {
-    const auto& current = datas[i];
-    const auto& after   = datas[i+1];
-    const char* c_current_byte = current.c_byte_;
-    uint64_t i_after_same_index(current.i_byte_length_);
-    if (i_max_length < i_after_same_index) {
-      i_max_length = i_after_same_index;
+  int i_offset(static_cast<int>(i_branch_base + 256));
+  i_tail_index = 1;
+  for (uint64_t i = 0; i < sub_arrays.size(); ++i) {
+    auto& sub_array = sub_arrays[i];
+    if (sub_array.i_begin_ == sub_array.i_end_)
+      continue;
+
+    const int i_insert(static_cast<int>(i_branch_base + i));
+    i_check_[i_insert] = i_branch_index;
+    if (sub_array.b_single_) { /* 1データのみなので分岐Nodeの子をLeafにする */
+      const auto& byte_array = datas[sub_array.i_end_ - 1];
+      const uint64_t i_tail_length(byte_array.i_byte_length_ - i_prefix_length - 1);
+      const NodeParts node_parts((i_tail_length ? byte_array.c_byte_ + i_prefix_length + 1 : nullptr),
+                                 i_tail_length, byte_array.result_);
+      i_base_[i_insert] = (-i_tail_index);  /* TailIndexはマイナス値 */
+      if (setTailInfo(i_tail_index, &node_parts)) {
+        return I_FAILED_MEMORY;
+      }
+      continue;
     }
 
-    sameIndex(i_after_same_index, current.i_byte_length_, c_current_byte, after.c_byte_);
-    if (i_after_same_index == after.i_byte_length_) {
-      positions[i].first = numeric_limits<uint64_t>::max();  /* 同一データ混在 */
-    } else {
-      positions[i].first  = i_before_same_index;
-      positions[i].second = (i_before_same_index < i_after_same_index ? i_after_same_index : i_before_same_index);
-      i_before_same_index = i_after_same_index;
+    /* 部分DoubleArrayのRootから分岐Nodeの子までは再配置しない */
+    auto& double_array = sub_array.double_array_;
+    const char* c_byte(datas[sub_array.i_begin_].c_byte_);
+    vector<int> i_path(1, 0);
+    for (uint64_t j = 0; j <= i_prefix_length; ++j) {
+      i_path.push_back(double_array.i_base_[i_path.back()] + static_cast<unsigned char>(c_byte[j]));
     }
-  }
-}
+    const int i_sub_branch(i_path.back());
 
+    const int i_tail_offset(i_tail_index - 1);
+    for (uint64_t j = 0; j < i_used_sizes[i]; ++j) {
+      const int i_check(double_array.i_check_[j]);
+      if (i_check == I_ARRAY_NO_DATA)
+        continue;
 
-/* 検索する                                       */
-/* c_byteにはNULLが途中に含まれる可能性がある為、 */
-/* バイト長も渡さないとダメ。                     */
-/* 引数のバイト列末尾のNULLも使用する             */
-/* @param c_byte        search bytes              */
-/* @param i_byte_length search data length        */
-/* @return search result                          */
-int64_t DoubleArray::search(
-  const char* c_byte,
-  uint64_t i_byte_length) const noexcept
-{
-  uint64_t i(0);
-  int i_base_index(0), i_check_index(0);
-  for (; i <= i_byte_length; ++i) { /* 終端記号の分があるので<=とする */
-    i_check_index  = i_base_[i_base_index];
-    i_check_index += static_cast<unsigned char>(c_byte[i]);
-    if (i_check_[i_check_index] != i_base_index) {
-      return I_SEARCH_NOHIT;  /* データが存在しない */
+      const int i_base(double_array.i_base_[j]);
+      i_base_[i_offset + j]  = (i_base > 0 ? i_base + i_offset : i_base - i_tail_offset);
+      i_check_[i_offset + j] = (i_check == i_sub_branch ? i_insert : i_check + i_offset);
     }
-
-    if (i_base_[i_check_index] < 0) {
-      break;
+    i_base_[i_insert] = double_array.i_base_[i_sub_branch] + i_offset;
+    for (const auto i_skip : i_path) {
+      i_base_[i_offset + i_skip]  = 0;
+      i_check_[i_offset + i_skip] = I_ARRAY_NO_DATA;
     }
-    i_base_index = i_check_index;
-  }
 
-  /* Tail処理 */
-  uint64_t i_tail_index(-i_base_[i_check_index]); /* Tail突入契機のマイナス値をプラスに変換 */
-  if (i < i_byte_length) {
-    ++i;
-    uint64_t i_compare_length(i_byte_length - i);
-    if (memcmp(&c_tail_[i_tail_index], &c_byte[i], i_compare_length + 1) == 0) {
-      return (i_result_ == nullptr ? I_HIT_DEFAULT : i_result_[i_tail_index + i_compare_length]);
+    const int i_sub_tail_size(sub_array.i_tail_index_ - 1);
+    memcpy(&c_tail_[i_tail_index],   &double_array.c_tail_[1],   sizeof(c_tail_[0])   * i_sub_tail_size);
+    memcpy(&i_result_[i_tail_index], &double_array.i_result_[1], sizeof(i_result_[0]) * i_sub_tail_size);
+    i_tail_index += i_sub_tail_size;
+    i_offset     += static_cast<int>(i_used_sizes[i]);
+    double_array.deleteMemory(true);
+
+    /* 部分DoubleArrayの構築の記録を加える */
+    i_base_check_extends_ += double_array.i_base_check_extends_;
+    i_tail_extends_       += double_array.i_tail_extends_;
+    for (int j = 0; j < I_PHASE_COUNT; ++j) {
+      i_build_times_[j] += double_array.i_build_times_[j];
     }
-  } else if (i == i_byte_length) {
-    return (i_result_ == nullptr ? I_HIT_DEFAULT : i_result_[i_tail_index]);
   }
 
-  return I_SEARCH_NOHIT;
+  return I_NO_ERROR;
 }
 
 
-/* 途中経過状態を取得しながら検索する            */
-/* @param sarch_parts   search position          */
-/* @param result        search result            */
-/* @param c_byte        search bytes             */
-/* @param i_byte_length search data length       */
-/* @return true : 続きがある  false : 続きが無い */
-bool DoubleArray::searchContinue(
-  DASearchParts& search_parts,
-  int64_t& result,
-  const char* c_byte,
-  const uint64_t i_byte_length) const noexcept
+/* 整列済みのデータを順に読み込みながらDoubleArrayを構築する */
+/* @param read_data 次のデータを取得する関数                 */
+/* @param i_option  構築オプション                           */
+/* @return 0 : 正常終了  0以外 : 異常終了                    */
+int DoubleArray::createDoubleArray(
+  const ReadFunction& read_data,
+  const int i_option) noexcept
 {
-  result = I_SEARCH_NOHIT;
+  if (i_option & I_CODE_TABLE)
+    return I_NOT_SUPPORTED;  /* 出現頻度を求めるには全データを先に読む必要がある */
 
-  uint64_t i(0), i_byte_index(0);
-  if (search_parts.i_tail_ == 0) {  /* Tailまで進んでいない */
-    for (; i < i_byte_length; ++i) {
-      search_parts.i_check_ = i_base_[search_parts.i_base_] + static_cast<unsigned char>(c_byte[i]);
-      if (i_check_[search_parts.i_check_] != search_parts.i_base_) {
-        return false; /* データが存在しない */
-      }
+  resetBuildStats();
+  const auto layout_start(chrono::steady_clock::now());  /* 読み込みと配置は分けられない */
+  try {
+    const char* c_byte(nullptr);
+    uint64_t i_byte_length(0);
+    int64_t result(0);
 
-      if (i_base_[search_parts.i_check_] < 0) {
-        i_byte_index = i + 1;
-        search_parts.i_tail_ = -i_base_[search_parts.i_check_]; /* マイナス値をプラスに変換 */
-        break;
-      }
-      search_parts.i_base_ = search_parts.i_check_;
+    /* 終端記号を付けてCopyする 空データは読み飛ばす */
+    auto readNext = [&](vector<char>& data, int64_t& data_result) {
+      do {
+        if (!read_data(c_byte, i_byte_length, data_result))
+          return false;
+      } while (i_byte_length == 0);
+      data.assign(c_byte, c_byte + i_byte_length);
+      data.push_back(C_TAIL_CHAR);
+      return true;
+    };
+
+    vector<char> current, next;
+    int64_t next_result(0);
+    if (!readNext(current, result))
+      return I_NO_ERROR;
+
+    i_option_ = I_NO_OPTION; /* 構築はBase/Check配列で行う */
+    if (keepMemory(true)) { /* メモリ確保 */
+      return I_FAILED_MEMORY;
     }
 
-    if (i >= i_byte_length) {
-      if (i_check_[i_base_[search_parts.i_base_]] == search_parts.i_base_) {
-        const int i_tail_index(i_base_[i_base_[search_parts.i_base_]]);
-        if (i_tail_index < 0) {
-          if (i_result_) result = i_result_[-i_tail_index]; /* ヒット */
-          else           result = I_HIT_DEFAULT;
+    DAEmptySlots empty_slots; /* 分岐するNodeのBaseを空き要素から探すのに使用 */
+    empty_slots.openBlock(i_check_, i_array_size_);
+    empty_slots.use(0);  /* Root */
+
+    /* nodes[i] : 先頭iByteが一致するNode 開いているのはnodes[0]からnodes[i_open]まで */
+    vector<DAStreamNode> nodes(1);
+    uint64_t i_open(0);
+    int i_tail_index(1); /* Tailの初期値 */
+    bool b_next(true);
+    while (b_next) {
+      /* 次のデータとの一致長 これより深いNodeには以降子が増えない */
+      uint64_t i_after_same(0);
+      b_next = readNext(next, next_result);
+      if (b_next) {
+        const uint64_t i_low_size(min(current.size(), next.size()));
+        while ((i_after_same < i_low_size) && (current[i_after_same] == next[i_after_same])) {
+          ++i_after_same;
         }
-        return true;
+        if ((i_after_same == current.size()) && (i_after_same == next.size())) {
+          current.swap(next);  /* 同一データは後のものを使う */
+          result = next_result;
+          continue;
+        }
+        if ((i_after_same == current.size()) || (i_after_same == next.size())
+        ||  (static_cast<unsigned char>(current[i_after_same]) > static_cast<unsigned char>(next[i_after_same]))) {
+          deleteMemory(true);
+          return I_FAILED_TRIE;  /* 整列されていない */
+        }
+      }
+
+      /* 前後のデータと分岐する位置までNodeを開き、残りはTailに格納 */
+      const uint64_t i_leaf(max(i_open, i_after_same));
+      if (nodes.size() <= i_leaf) {
+        nodes.resize(i_leaf + 1);
+      }
+      for (uint64_t i = i_open + 1; i <= i_leaf; ++i) {
+        nodes[i].init();
+      }
+
+      const uint64_t i_tail_size(current.size() - i_leaf - 1);
+      const NodeParts node_parts((i_tail_size ? &current[i_leaf + 1] : nullptr), i_tail_size, result);
+      nodes[i_leaf].children_.emplace_back(current[i_leaf], -i_tail_index, 0, 0);  /* TailIndexはマイナス値 */
+      if (setTailInfo(i_tail_index, &node_parts)) {
+        return I_FAILED_MEMORY; /* 構築失敗 */
       }
+
+      for (uint64_t i = i_leaf; i > i_after_same; --i) {
+        if (closeStreamNode(empty_slots, nodes, i, current[i - 1])) {
+          return I_FAILED_MEMORY; /* 構築失敗 */
+        }
+      }
+      i_open = i_after_same;
+
+      current.swap(next);
+      result = next_result;
     }
-  }
 
-  /* Tail処理 */
-  uint64_t i_compare_size(i_byte_length - i_byte_index);
-  if (memcmp(&c_tail_[search_parts.i_tail_], &c_byte[i_byte_index], i_compare_size) != 0) {
-    return false;  /* データが存在しない　Tailの途中で不一致 */
+    if (closeStreamNode(empty_slots, nodes, 0, 0)) { /* Root */
+      return I_FAILED_MEMORY;
+    }
+    i_build_times_[I_PHASE_LAYOUT] += getElapsedTime(layout_start);
+
+    const auto optimize_start(chrono::steady_clock::now());
+    const int i_error(completeDoubleArray(i_tail_index, i_option));
+    i_build_times_[I_PHASE_OPTIMIZE] += getElapsedTime(optimize_start);
+
+    return i_error;
+  } catch (...) {
+    deleteMemory(true);
+    return I_FAILED_MEMORY;
   }
+}
 
-  i_byte_index         += i_compare_size;
-  search_parts.i_tail_ += static_cast<int>(i_compare_size);
 
-  if (i_byte_index >= i_byte_length) {
-    if (c_tail_[search_parts.i_tail_] == C_TAIL_CHAR) {
-      if (i_result_) result = i_result_[search_parts.i_tail_];  /* ヒット */
-      else           result = I_HIT_DEFAULT;
-    } else {
-      return true;
+/* 整列済みのテキストファイルからDoubleArrayを構築する */
+/* @param c_file_path ファイルパス                     */
+/* @param i_option    構築オプション                   */
+/* @return 0 : 正常終了  0以外 : 異常終了              */
+int DoubleArray::createDoubleArray(
+  const char* c_file_path,
+  const int i_option) noexcept
+{
+  FILE* fp = fopen(c_file_path, "rb");
+  if (fp == nullptr)
+    return I_FAIELD_FILE_IO;
+
+  char* c_line(nullptr);
+  size_t i_capacity(0);
+  int64_t i_line_number(0);
+  auto read_line = [&](const char*& c_byte, uint64_t& i_byte_length, int64_t& result) {
+    const ssize_t i_read(getline(&c_line, &i_capacity, fp));
+    if (i_read < 0)
+      return false;
+
+    ++i_line_number;
+    i_byte_length = static_cast<uint64_t>(i_read);
+    if ((i_byte_length > 0) && (c_line[i_byte_length - 1] == '\n')) --i_byte_length;
+    if ((i_byte_length > 0) && (c_line[i_byte_length - 1] == '\r')) --i_byte_length;
+
+    result = i_line_number;
+    const char* c_tab(static_cast<const char*>(memrchr(c_line, '\t', i_byte_length)));
+    if (c_tab) {
+      result = strtoll(c_tab + 1, nullptr, 10);
+      i_byte_length = c_tab - c_line;
     }
+    c_byte = c_line;
+    return true;
+  };
+
+  int i_error(createDoubleArray(read_line, i_option));
+  if (ferror(fp)) {
+    deleteMemory(true);
+    i_error = I_FAIELD_FILE_IO;
   }
+  free(c_line);
+  fclose(fp);
 
-  return false;
+  return i_error;
 }
 
 
-/* DoubleArray情報を書き込む                         */
-/* @param i_write_size 書き込んだデータサイズ        */
-/* @param fp           OutputFileStream              */
-/* @return I_DA_NO_ERROR : 正常終了 0以外 : 異常終了 */
-int DoubleArray::writeBinary(
-  int64_t& i_write_size,
-  FILE* fp) const noexcept
+/* 子が全て確定したNodeを閉じる                */
+/* @param empty_slots 空き要素情報             */
+/* @param nodes       Rootからの開いているNode */
+/* @param i_depth     閉じるNodeの深さ         */
+/* @param c_label     閉じるNodeへ遷移するByte */
+/* @return Error Code                          */
+int DoubleArray::closeStreamNode(
+  DAEmptySlots& empty_slots,
+  vector<DAStreamNode>& nodes,
+  const uint64_t i_depth,
+  const unsigned char c_label) noexcept
 {
-  try {
-    if (checkInit()) {
-      fwrite(&i_array_size_,  sizeof(i_array_size_),  1,             fp);
-      fwrite(&i_tail_size_,   sizeof(i_tail_size_),   1,             fp);
-      fwrite(&i_result_size_, sizeof(i_result_size_), 1,             fp);
-      fwrite(i_base_,         sizeof(i_base_[0]),     i_array_size_, fp);
-      fwrite(i_check_,        sizeof(i_check_[0]),    i_array_size_, fp);
-      fwrite(c_tail_,         sizeof(c_tail_[0]),     i_tail_size_,  fp);
-      if (i_result_size_) {
-        fwrite(i_result_, sizeof(i_result_[0]), i_result_size_, fp);
-      }
+  auto& node = nodes[i_depth];
+  unsigned char c_labels[256] = { 0 };
+  int i_label_count(0);
+  for (const auto& child : node.children_) {
+    c_labels[i_label_count++] = child.c_label_;
+  }
 
-      i_write_size += sizeof(i_array_size_);
-      i_write_size += sizeof(i_tail_size_);
-      i_write_size += sizeof(i_result_size_);
-      i_write_size += sizeof(i_base_[0])  * i_array_size_;
-      i_write_size += sizeof(i_check_[0]) * i_array_size_;
-      i_write_size += sizeof(c_tail_[0])  * i_tail_size_;
-      if (i_result_size_) {
-        i_write_size += sizeof(i_result_[0]) * i_result_size_;
-      }
-    } else {
-      int i_zero(0);
-      fwrite(&i_zero, sizeof(i_zero), 1, fp);
-      i_write_size += sizeof(i_zero);
+  unsigned int i_base_value;
+  if (getBaseValue(i_base_value, empty_slots, c_labels, i_label_count)) {
+    return I_FAILED_MEMORY; /* 構築失敗 */
+  }
+
+  /* 子を配置して孫のCheckを設定 子のCheckは仮に0とし、親を閉じた時に設定する */
+  for (const auto& child : node.children_) {
+    const int i_insert(child.c_label_ + i_base_value);
+    i_base_[i_insert]  = child.i_base_;
+    i_check_[i_insert] = 0;
+    for (uint32_t i = 0; i < child.i_label_count_; ++i) {
+      i_check_[child.i_base_ + node.c_grand_labels_[child.i_label_begin_ + i]] = i_insert;
     }
   }
-  catch (...) {
-    return I_FAIELD_FILE_IO;
+
+  if (i_depth == 0) {
+    i_base_[0] = i_base_value;  /* Rootの子のCheckは0で確定 */
+    return I_NO_ERROR;
+  }
+
+  try {
+    auto& parent = nodes[i_depth - 1];
+    parent.children_.emplace_back(c_label, static_cast<int>(i_base_value),
+                                  static_cast<uint32_t>(parent.c_grand_labels_.size()), static_cast<uint32_t>(i_label_count));
+    parent.c_grand_labels_.insert(parent.c_grand_labels_.end(), c_labels, c_labels + i_label_count);
+  } catch (...) {
+    return I_FAILED_MEMORY;
   }
 
   return I_NO_ERROR;
 }
 
 
-/* DoubleArray情報を読み込む                 */
-/* @param i_read_size 読み込んだデータサイズ */
-/* @param fp InputFileStream                 */
-/* @return 0 : 正常終了 0以外 : 異常終了     */
-int DoubleArray::readBinary(
-  int64_t& i_read_size,
-  FILE* fp) noexcept
+/* 構築後の共通処理                                              */
+/* @param i_tail_index Tail配列のデータが格納されている最終Index */
+/* @param i_option     構築オプション                            */
+/* @return Error Code                                            */
+int DoubleArray::completeDoubleArray(
+  const int i_tail_index,
+  const int i_option) noexcept
 {
-  try {
-    if (1 != fread(&i_array_size_, sizeof(i_array_size_), 1, fp)) /* 配列サイズ */
-      throw;
+  if (i_option & I_TAIL_UNITY) {
+    delete[] i_result_;
+    i_result_      = nullptr;
+    i_result_size_ = 0;
+  }
 
-    if (i_array_size_) {
-      if ((1 != fread(&i_tail_size_,   sizeof(i_tail_size_),   1, fp)) /* Tail文字列サイズ */
-      ||  (1 != fread(&i_result_size_, sizeof(i_result_size_), 1, fp)) /* Tail結果サイズ   */
-      ||  (keepMemory())) /* 配列サイズが確定したのでメモリ確保 */
-        throw;
+  if (optimizeMemory(i_tail_index)) {
+    return I_FAILED_MEMORY;
+  }
 
-      if ((static_cast<size_t>(i_array_size_) != fread(i_base_,  sizeof(i_base_[0]),  i_array_size_, fp))   /* Base     */
-      ||  (static_cast<size_t>(i_array_size_) != fread(i_check_, sizeof(i_check_[0]), i_array_size_, fp))   /* Check    */
-      ||  (static_cast<size_t>(i_tail_size_)  != fread(c_tail_,  sizeof(c_tail_[0]),  i_tail_size_,  fp)))  /* Tail文字 */
-        throw;
+  if (i_option & I_KEY_ID) {
+    if (convertKeyId())
+      return I_FAILED_MEMORY;
+  } else if ((i_option & I_SHARE_TAIL) && (convertSharedTail())) {
+    return I_FAILED_MEMORY;
+  }
 
-      if (i_result_size_) {
-        if (static_cast<size_t>(i_result_size_) != fread(i_result_, sizeof(i_result_[0]), i_result_size_, fp)) /* Tail結果 */
-          throw;
-      } else {
-        i_result_ = nullptr;
-      }
+  if ((i_option & I_COMPACT_RESULT) && (i_result_) && (convertCompactResult()))
+    return I_FAILED_MEMORY;
 
-      i_read_size += sizeof(i_tail_size_);
-      i_read_size += sizeof(i_result_size_);
-      i_read_size += sizeof(i_base_[0])  * i_array_size_;
-      i_read_size += sizeof(i_check_[0]) * i_array_size_;
-      if (i_result_size_) {
-        i_read_size += sizeof(i_result_[0]) * i_result_size_;
-      }
-    } else {
-      i_read_size += sizeof(i_array_size_);
-    }
+  if ((i_option & I_UNIT_LAYOUT) && (convertUnitLayout()))
+    return I_FAILED_MEMORY;
+
+  int i_error(I_NO_ERROR);
+  if ((i_option & I_REVERSE_INDEX) && ((i_result_) || (result_blocks_))) {
+    i_error = createReverseIndex();
+  }
+  if ((i_error == I_NO_ERROR) && (i_option & I_SCAN_TABLE)) {
+    i_error = createScanTable();
+  }
+
+  return i_error;
+}
+
+
+/* Base/Check配列をUnit形式に変換する */
+/* @return Error Code                 */
+int DoubleArray::convertUnitLayout() noexcept
+{
+  try {
+    units_ = new DAUnit[i_array_size_];
   } catch (...) {
     deleteMemory();
-    return I_FAIELD_FILE_IO;
+    return I_FAILED_MEMORY;
+  }
+
+  for (uint64_t i = 0; i < i_array_size_; ++i) {
+    units_[i].i_base_  = i_base_[i];
+    units_[i].i_check_ = i_check_[i];
   }
 
+  delete[] i_base_;
+  delete[] i_check_;
+  i_base_    = nullptr;
+  i_check_   = nullptr;
+  i_option_ |= I_UNIT_LAYOUT;
+
   return I_NO_ERROR;
 }
 
 
-/* 内部データを取得する                  */
-/* @param i_array_size  配列サイズ       */
-/* @param i_tail_size   Tail文字列サイズ */
-/* @param i_result_size Tail結果サイズ   */
-/* @param i_base        Base配列         */
-/* @param i_check       Check配列        */
-/* @param i_result      Tail結果配列     */
-/* @param c_tail        Tail文字配列     */
-void DoubleArray::getDoubleArrayData(
-  uint64_t& i_array_size,
-  uint64_t& i_tail_size,
-  uint64_t& i_result_size,
-  const int*& i_base,
-  const int*& i_check,
-  const int64_t*& i_result,
-  const char*& c_tail) const noexcept
+/* 同じ結果を持つTailのうち、他のTailの末尾と一致するものは共有する */
+/* @return Error Code                                               */
+int DoubleArray::convertSharedTail() noexcept
 {
-  i_array_size  = i_array_size_;
-  i_tail_size   = i_tail_size_;
-  i_result_size = i_result_size_;
-  i_base        = i_base_;
-  i_check       = i_check_;
-  i_result      = i_result_;
-  c_tail        = c_tail_;
-}
+  vector<pair<int, int>> tails; /* LeafのBaseCheckIndex, Tail終端記号のIndex */
+  vector<int> i_owners;         /* 重ねる先のtails位置 */
+  vector<int> i_new_indexes;    /* 共有後のTail開始Index */
+  try {
+    for (uint64_t i = 1; i < i_array_size_; ++i) {
+      if ((i_check_[i] == I_ARRAY_NO_DATA) || (i_base_[i] >= 0))
+        continue;
 
+      int i_tail_index(-i_base_[i]);
+      while (c_tail_[i_tail_index] != C_TAIL_CHAR) {
+        ++i_tail_index;
+      }
+      tails.emplace_back(static_cast<int>(i), i_tail_index);
+    }
+    i_owners.resize(tails.size());
+    i_new_indexes.resize(tails.size());
+  } catch (...) {
+    deleteMemory();
+    return I_FAILED_MEMORY;
+  }
 
-/* 内部データを外部から設定する          */
-/* @param i_array_size  配列サイズ       */
-/* @param i_tail_size   Tail文字列サイズ */
-/* @param i_result_size Tail結果サイズ   */
-/* @param i_base        Base配列         */
-/* @param i_check       Check配列        */
-/* @param i_result      Tail結果配列     */
-/* @param c_tail        Tail文字配列     */
-int DoubleArray::setDoubleArrayData(
-  int i_array_size,
-  int i_tail_size,
-  int i_result_size,
-  const int* i_base,
-  const int* i_check,
-  const int64_t* i_result,
-  const char* c_tail) noexcept
-{
-  i_array_size_  = i_array_size;  /* 配列サイズ       */
-  i_tail_size_   = i_tail_size;   /* Tail文字列サイズ */
-  i_result_size_ = i_result_size; /* Tail結果サイズ   */
+  auto getResult = [this](const int i_tail_index) {
+    return (i_result_ ? i_result_[i_tail_index] : I_HIT_DEFAULT);
+  };
+  auto getLength = [this](const pair<int, int>& tail) {
+    return tail.second + i_base_[tail.first] + 1;  /* 終端記号を含む */
+  };
 
-  if (keepMemory()) /* 配列サイズが確定したのでメモリ確保 */
+  /* 結果毎に、Tailを末尾から比較した順に並べる */
+  sort(tails.begin(), tails.end(), [&](const pair<int, int>& left, const pair<int, int>& right) {
+    if (getResult(left.second) != getResult(right.second))
+      return getResult(left.second) < getResult(right.second);
+
+    const int i_left_begin(-i_base_[left.first]), i_right_begin(-i_base_[right.first]);
+    int i_left(left.second), i_right(right.second);
+    for (; (i_left >= i_left_begin) && (i_right >= i_right_begin); --i_left, --i_right) {
+      if (c_tail_[i_left] != c_tail_[i_right])
+        return static_cast<unsigned char>(c_tail_[i_left]) < static_cast<unsigned char>(c_tail_[i_right]);
+    }
+    return (i_left - i_left_begin) < (i_right - i_right_begin); /* 短い方が先 */
+  });
+
+  /* 直後のTailの末尾に含まれていれば、その重ねる先を引き継ぐ */
+  uint64_t i_new_tail_size(1);  /* TailIndexは1から */
+  for (int64_t i = static_cast<int64_t>(tails.size()) - 1; i >= 0; --i) {
+    i_owners[i] = static_cast<int>(i);
+    if (i + 1 < static_cast<int64_t>(tails.size())) {
+      const auto& tail = tails[i];
+      const auto& next = tails[i + 1];
+      const int i_length(getLength(tail));
+      if ((getResult(tail.second) == getResult(next.second))
+      &&  (i_length <= getLength(next))
+      &&  (memcmp(&c_tail_[tail.second - i_length + 1], &c_tail_[next.second - i_length + 1], i_length) == 0)) {
+        i_owners[i] = i_owners[i + 1];
+        continue;
+      }
+    }
+    i_new_tail_size += getLength(tails[i]);
+  }
+
+  char* c_new_tail      = nullptr;
+  int64_t* i_new_result = nullptr;
+  try {
+    c_new_tail = new char[i_new_tail_size];
+    if (i_result_) {
+      i_new_result = new int64_t[i_new_tail_size];
+      memset(i_new_result, 0, sizeof(i_new_result[0]) * i_new_tail_size);
+    }
+  } catch (...) {
+    delete[] c_new_tail;
+    deleteMemory();
     return I_FAILED_MEMORY;
+  }
+  c_new_tail[0] = C_TAIL_CHAR;
 
+  /* 共有元のTailは元の並び順で配置する */
+  vector<int> i_placements;
   try {
-    memcpy(i_base_,  i_base,  sizeof(i_base_[0])  * i_array_size_);
-    memcpy(i_check_, i_check, sizeof(i_check_[0]) * i_array_size_);
-    memcpy(c_tail_,  c_tail,  sizeof(c_tail_[0])  * i_tail_size_);
-    if (i_result) {
-      memcpy(i_result_, i_result, sizeof(i_result_[0]) * i_result_size_);
-    } else {
-      i_result_ = nullptr;
+    for (uint64_t i = 0; i < tails.size(); ++i) {
+      if (i_owners[i] == static_cast<int>(i)) {
+        i_placements.push_back(static_cast<int>(i));
+      }
     }
   } catch (...) {
+    delete[] c_new_tail;
+    delete[] i_new_result;
     deleteMemory();
     return I_FAILED_MEMORY;
   }
+  sort(i_placements.begin(), i_placements.end(), [&tails](const int i_left, const int i_right) {
+    return tails[i_left].second < tails[i_right].second;
+  });
+
+  int i_new_index(1);
+  for (const int i_placement : i_placements) {
+    const auto& tail = tails[i_placement];
+    const int i_length(getLength(tail));
+    memcpy(&c_new_tail[i_new_index], &c_tail_[-i_base_[tail.first]], i_length);
+    if (i_new_result) {
+      i_new_result[i_new_index + i_length - 1] = i_result_[tail.second];
+    }
+    i_new_indexes[i_placement] = i_new_index;
+    i_new_index += i_length;
+  }
+
+  for (uint64_t i = 0; i < tails.size(); ++i) {
+    const auto& owner = tails[i_owners[i]];
+    i_new_indexes[i] = i_new_indexes[i_owners[i]] + getLength(owner) - getLength(tails[i]);
+  }
+  for (uint64_t i = 0; i < tails.size(); ++i) {
+    i_base_[tails[i].first] = -i_new_indexes[i];
+  }
+
+  delete[] c_tail_;
+  delete[] i_result_;
+  c_tail_        = c_new_tail;
+  i_result_      = i_new_result;
+  i_tail_size_   = i_new_tail_size;
+  i_result_size_ = (i_new_result ? i_new_tail_size : 0);
+  i_option_     |= I_SHARE_TAIL;
 
   return I_NO_ERROR;
 }
 
 
-/* 結果IndexからByte情報を復元する                               */
-/* @param c_info         復元したByte情報 呼び出し側でdeleteする */
-/* @param i_reuslt_index 復元する結果Index                       */
-void DoubleArray::reproductionFromIndex(
-  char*& c_info,
-  const int64_t i_result_index) const noexcept
+/* Leafが指すTail終端記号の位置をbit列にする */
+/* @param i_result_count 終端記号の数        */
+/* @return Error Code                        */
+int DoubleArray::createResultBlocks(
+  uint64_t& i_result_count) noexcept
 {
-  c_info = nullptr;
-  uint64_t i_last(0);
-  for (uint64_t i = 0; i < i_result_size_; ++i) {
-    if (i_result_[i] == i_result_index) {
-      i_last = i;
-    }
+  const uint64_t i_block_count((i_tail_size_ + DAResultBlock::I_BLOCK_SIZE - 1) / DAResultBlock::I_BLOCK_SIZE);
+  try {
+    result_blocks_ = new DAResultBlock[i_block_count];
+  } catch (...) {
+    deleteMemory();
+    return I_FAILED_MEMORY;
   }
+  memset(result_blocks_, 0, sizeof(result_blocks_[0]) * i_block_count);
 
-  if (i_last == 0) {
-    return; /* 指定のIndexは無し */
+  /* Leafから辿れる終端記号だけが結果を持つ */
+  for (uint64_t i = 1; i < i_array_size_; ++i) {
+    if ((i_check_[i] == I_ARRAY_NO_DATA) || (i_base_[i] >= 0))
+      continue;
+
+    uint64_t i_tail_index(-i_base_[i]);
+    while (c_tail_[i_tail_index] != C_TAIL_CHAR) {
+      ++i_tail_index;
+    }
+    result_blocks_[i_tail_index / DAResultBlock::I_BLOCK_SIZE].i_bits_[(i_tail_index % DAResultBlock::I_BLOCK_SIZE) / 64] |= (1ULL << (i_tail_index % 64));
   }
 
-  vector<char> datas;
-  int64_t i_tail_index(--i_last);  /* 終端記号を指しているので一つ前にする */
-  while (c_tail_[i_tail_index]) {
-    datas.push_back(c_tail_[i_tail_index--]);  /* Tail部分のデータ */
+  i_result_count = 0;  /* I_SHARE_TAILで共有した終端記号は1つと数える */
+  for (uint64_t i = 0; i < i_block_count; ++i) {
+    result_blocks_[i].i_rank_ = i_result_count;
+    for (uint64_t i_word = 0; i_word < DAResultBlock::I_WORD_COUNT; ++i_word) {
+      i_result_count += __builtin_popcountll(result_blocks_[i].i_bits_[i_word]);
+    }
   }
-  ++i_tail_index; /* Tail先頭の位置にするのでIncrement */
 
-  uint64_t i_array_index(0); /* base位置特定 */
-  for (uint64_t i = 0; i < i_array_size_; ++i) {
-    if ((i_base_[i] < 0)
-    &&  ((-i_base_[i]) == i_tail_index)) {
-      i_array_index = i;
-      break;
+  return I_NO_ERROR;
+}
+
+
+/* TailをKeyの辞書順に並べ替え、終端記号の順位をKey IDにする */
+/* @return Error Code                                        */
+int DoubleArray::convertKeyId() noexcept
+{
+  vector<int> i_leaves; /* 辞書順のLeaf */
+  vector<int> i_nodes;  /* 未処理のNode */
+  uint64_t i_new_tail_size(1);  /* TailIndexは1から */
+  try {
+    i_nodes.push_back(0);
+    while (!i_nodes.empty()) {
+      const int i_node(i_nodes.back());
+      i_nodes.pop_back();
+      if (i_base_[i_node] < 0) {
+        i_leaves.push_back(i_node);
+        i_new_tail_size += strlen(&c_tail_[-i_base_[i_node]]) + 1;
+        continue;
+      }
+
+      for (int i_byte = 0xff; i_byte >= 0; --i_byte) {  /* 小さいByteから取り出す */
+        const int i_child(i_base_[i_node] + c_code_table_[i_byte]);
+        if (i_check_[i_child] == i_node) {
+          i_nodes.push_back(i_child);
+        }
+      }
     }
+  } catch (...) {
+    deleteMemory();
+    return I_FAILED_MEMORY;
   }
 
-  while (i_array_index != 0) {
-    uint64_t i_char = (i_array_index - i_base_[i_check_[i_array_index]]) & 0xff;
-    datas.push_back(static_cast<char>(i_char));
-    i_array_index = i_check_[i_array_index];
+  char* c_new_tail = nullptr;
+  try {
+    c_new_tail = new char[i_new_tail_size];
+  } catch (...) {
+    deleteMemory();
+    return I_FAILED_MEMORY;
   }
+  c_new_tail[0] = C_TAIL_CHAR;
 
-  int i_index(0);
-  c_info = new char[datas.size() + 1];
-  for (auto data = datas.crbegin(), data_end = datas.crend(); data != data_end; ++data) {
-    c_info[i_index++] = *data;
+  uint64_t i_new_index(1);
+  for (const int i_leaf : i_leaves) {
+    const char* c_tail(&c_tail_[-i_base_[i_leaf]]);
+    const uint64_t i_length(strlen(c_tail) + 1);  /* 終端記号を含む */
+    memcpy(&c_new_tail[i_new_index], c_tail, i_length);
+    i_base_[i_leaf] = -static_cast<int>(i_new_index);
+    i_new_index    += i_length;
   }
-  c_info[i_index] = 0x00; /* 終端記号 */
+
+  delete[] c_tail_;
+  delete[] i_result_;
+  c_tail_        = c_new_tail;
+  i_result_      = nullptr;
+  i_tail_size_   = i_new_tail_size;
+  i_result_size_ = 0;
+
+  uint64_t i_key_count(0);
+  if (createResultBlocks(i_key_count))
+    return I_FAILED_MEMORY;
+
+  i_option_ |= I_KEY_ID;
+
+  return I_NO_ERROR;
 }
 
+
+/* Tail位置毎の結果配列をKey毎の詰めた配列に変換する */
+/* @return Error Code                                */
+int DoubleArray::convertCompactResult() noexcept
+{
+  uint64_t i_result_count(0);
+  if (createResultBlocks(i_result_count))
+    return I_FAILED_MEMORY;
+
+  const uint64_t i_block_count((i_tail_size_ + DAResultBlock::I_BLOCK_SIZE - 1) / DAResultBlock::I_BLOCK_SIZE);
+  int64_t i_min(numeric_limits<int64_t>::max()), i_max(numeric_limits<int64_t>::min());
+  for (uint64_t i = 0; i < i_block_count; ++i) {
+    for (uint64_t i_word = 0; i_word < DAResultBlock::I_WORD_COUNT; ++i_word) {
+      for (uint64_t i_bits = result_blocks_[i].i_bits_[i_word]; i_bits; i_bits &= i_bits - 1) {
+        const uint64_t i_tail_index(i * DAResultBlock::I_BLOCK_SIZE + i_word * 64 + __builtin_ctzll(i_bits));
+        i_min = min(i_min, i_result_[i_tail_index]);
+        i_max = max(i_max, i_result_[i_tail_index]);
+      }
+    }
+  }
+
+  /* 最小値からの差分が収まるbit幅で詰める */
+  uint64_t i_width(0);
+  if (i_result_count) {
+    for (uint64_t i_range = static_cast<uint64_t>(i_max) - static_cast<uint64_t>(i_min); i_range; i_range >>= 1) {
+      ++i_width;
+    }
+  } else {
+    i_min = 0;
+  }
+
+  i_packed_size_ = 2 + (i_result_count * i_width + 63) / 64;
+  try {
+    i_packed_result_ = new uint64_t[i_packed_size_];
+  } catch (...) {
+    deleteMemory();
+    return I_FAILED_MEMORY;
+  }
+  memset(i_packed_result_, 0, sizeof(i_packed_result_[0]) * i_packed_size_);
+  i_packed_result_[0] = static_cast<uint64_t>(i_min);
+  i_packed_result_[1] = i_width;
+
+  uint64_t* i_words(i_packed_result_ + 2);
+  uint64_t i_bit_position(0);
+  for (uint64_t i = 0; (i_width) && (i < i_block_count); ++i) {
+    for (uint64_t i_word = 0; i_word < DAResultBlock::I_WORD_COUNT; ++i_word) {
+      for (uint64_t i_bits = result_blocks_[i].i_bits_[i_word]; i_bits; i_bits &= i_bits - 1) {
+        const uint64_t i_tail_index(i * DAResultBlock::I_BLOCK_SIZE + i_word * 64 + __builtin_ctzll(i_bits));
+        const uint64_t i_value(static_cast<uint64_t>(i_result_[i_tail_index]) - static_cast<uint64_t>(i_min));
+        i_words[i_bit_position / 64] |= i_value << (i_bit_position % 64);
+        if (i_bit_position % 64 + i_width > 64) {
+          i_words[i_bit_position / 64 + 1] |= i_value >> (64 - i_bit_position % 64);
+        }
+        i_bit_position += i_width;
+      }
+    }
+  }
+
+  delete[] i_result_;
+  i_result_      = nullptr;
+  i_result_size_ = 0;
+  i_option_     |= I_COMPACT_RESULT;
+
+  return I_NO_ERROR;
+}
+
+
+/* 入力データからTRIE構造を構築する              */
+/* @param root_node   構築したTrie Root Node     */
+/* @param arena       Node, NodePartsの確保先    */
+/* @param datas       基にするデータ 整列済み    */
+/* @param i_data_count データ数                  */
+/* @param i_overlap_time 重複Index情報の作成時間 */
+/* @return Error Code                            */
+int DoubleArray::createTrie(
+  TrieNode*& root_node,
+  DABuildArena& arena,
+  const ByteArray* datas,
+  const uint64_t i_data_count,
+  uint64_t& i_overlap_time) const noexcept
+{
+  uint64_t i_max_length;
+  constexpr uint64_t i_max_value = numeric_limits<uint64_t>::max();
+  vector<TrieNode*> trie_nodes;
+  vector<pair<uint64_t, uint64_t>> positions;
+  try {
+    const auto overlap_start(chrono::steady_clock::now());
+    positions.assign(i_data_count, make_pair(0, 0)); /* TailPosition */
+    createOverlapPositions(i_max_length, positions, datas, i_data_count); /* TailPositionデータ作成 */
+    i_overlap_time = getElapsedTime(overlap_start);
+
+    /* 切り出すNode数を数えて一括確保 */
+    uint64_t i_node_count(0), i_parts_count(0);
+    for (const auto& position : positions) {
+      if (position.first != i_max_value) {
+        i_node_count += position.second - position.first + 1;
+        ++i_parts_count;
+      }
+    }
+    arena.reserve(i_node_count, i_parts_count);
+    trie_nodes.assign(i_max_length, nullptr);
+  } catch (...) {
+    return I_FAILED_MEMORY;
+  }
+
+  for (uint64_t i_data = 0; i_data < i_data_count; ++i_data) {
+    const auto& byte_array = datas[i_data];
+    const auto i_start(positions[i_data].first);
+    const auto i_tail(positions[i_data].second);
+    if (i_start == i_max_value) /* データが重複かチェック */
+      continue;
+
+    const char* c_tail(nullptr);
+    int64_t i_tail_size(0);
+    if (i_tail < byte_array.i_byte_length_ - 1) {
+      i_tail_size = byte_array.i_byte_length_ - i_tail - 1;
+      c_tail = byte_array.c_byte_ + i_tail + 1;
+    }
+
+    auto branch_node = trie_nodes[i_start];
+    auto node_parts  = arena.createParts(c_tail, i_tail_size, byte_array.result_);
+    auto next_node   = arena.createNode(byte_array.c_byte_[i_tail], nullptr, node_parts);
+    trie_nodes[i_tail] = next_node;
+
+    for (int64_t i = i_tail - 1; i >= static_cast<int64_t>(i_start); --i) {
+      trie_nodes[i] = next_node = arena.createNode(byte_array.c_byte_[i], next_node, nullptr);
+    }
+
+    if (root_node == nullptr) {
+      root_node = trie_nodes[i_start];
+    }
+
+    if (branch_node != nullptr) {
+      branch_node->p_same_layer_ = trie_nodes[i_start];
+    }
+  }
+
+  return I_NO_ERROR;
+}
+
+
+/* Trie構造からDoubleArrayを構築する         */
+/* @param i_tail_index 書き込み開始TailIndex */
+/* @param empty_slots  空き要素情報          */
+/* @param root_node    Trie Root Node        */
+/* @return Error Code                        */
+int DoubleArray::createDoubleArrayFromTrie(
+  int& i_tail_index,
+  DAEmptySlots& empty_slots,
+  const TrieNode* root_node) noexcept
+{
+  /* 作業Stack 次に処理する兄弟NodeとそのBase値 */
+  vector<pair<const TrieNode*, unsigned int>> work_stack;
+  unsigned int i_base_value;
+  if (setBranchNode(i_base_value, empty_slots, root_node, 0)) {
+    return I_FAILED_MEMORY; /* 構築失敗 */
+  }
+
+  try {
+    work_stack.emplace_back(root_node, i_base_value);
+    while (!work_stack.empty()) {
+      auto& work = work_stack.back();
+      const auto current_node = work.first;
+      if (current_node == nullptr) { /* 兄弟を全て処理した */
+        work_stack.pop_back();
+        continue;
+      }
+      work.first = current_node->p_same_layer_;
+
+      const int i_insert(current_node->c_byte_ + work.second);
+      if (current_node->node_parts_) {
+        i_base_[i_insert] = (-i_tail_index);  /* TailIndexはマイナス値 */
+
+        if (setTailInfo(i_tail_index, current_node->node_parts_)) {
+          return I_FAILED_MEMORY; /* 構築失敗 */
+        }
+      }
+      if (current_node->p_child_top_ != nullptr) {
+        if (setBranchNode(i_base_value, empty_slots, current_node->p_child_top_, i_insert)) {
+          return I_FAILED_MEMORY; /* 構築失敗 */
+        }
+        work_stack.emplace_back(current_node->p_child_top_, i_base_value); /* 子を先に処理する */
+      }
+    }
+  } catch (...) {
+    return I_FAILED_MEMORY;
+  }
+
+  return I_NO_ERROR;
+}
+
+
+/* 兄弟NodeのBase値を決めてCheckを設定する */
+/* @param i_base_value 求めたBase値        */
+/* @param empty_slots  空き要素情報        */
+/* @param trie_node    兄弟Nodeの先頭      */
+/* @param i_base_index 親のBaseCheckIndex  */
+/* @return Error Code                      */
+int DoubleArray::setBranchNode(
+  unsigned int& i_base_value,
+  DAEmptySlots& empty_slots,
+  const TrieNode* trie_node,
+  const int i_base_index) noexcept
+{
+  unsigned char c_labels[256] = { 0 };
+  int i_label_count(0);
+  for (auto current_node = trie_node; current_node != nullptr; current_node = current_node->p_same_layer_) {
+    c_labels[i_label_count++] = current_node->c_byte_;
+  }
+
+  if (getBaseValue(i_base_value, empty_slots, c_labels, i_label_count)) {
+    return I_FAILED_MEMORY; /* 構築失敗 */
+  }
+  i_base_[i_base_index] = i_base_value;
+
+  /* 子を処理する前にcheckを設定 */
+  for (int i = 0; i < i_label_count; ++i) {
+    i_check_[c_labels[i] + i_base_value] = i_base_index;
+  }
+
+  return I_NO_ERROR;
+}
+
+
+/* Baseの値を求める 空き要素からのみ候補を探す */
+/* @param i_base_value  求めたBase値           */
+/* @param empty_slots   空き要素情報           */
+/* @param c_labels      分岐するByte 昇順      */
+/* @param i_label_count 分岐数                 */
+/* @return Error Code                          */
+int DoubleArray::getBaseValue(
+  unsigned int& i_base_value,
+  DAEmptySlots& empty_slots,
+  const unsigned char* c_labels,
+  const int i_label_count) noexcept
+{
+  const int i_first_label(c_labels[0]);
+  const int i_last_label(c_labels[i_label_count - 1]);
+
+  int i_empty(empty_slots.front());
+  while (true) {
+    if (i_empty == DAEmptySlots::I_NONE) { /* 候補が無いのでBlockを開く */
+      const uint64_t i_old_size(empty_slots.size());
+      if ((i_array_size_ < i_old_size + DAEmptySlots::I_BLOCK_SIZE)
+      &&  (baseCheckExtendMemory(i_old_size + DAEmptySlots::I_BLOCK_SIZE))) {
+        return I_FAILED_MEMORY;
+      }
+      empty_slots.openBlock(i_check_, i_array_size_);
+      i_empty = empty_slots.front();
+      while ((i_empty != DAEmptySlots::I_NONE) && (static_cast<uint64_t>(i_empty) < i_old_size)) {
+        i_empty = empty_slots.next(i_empty);  /* 開いたBlockから探す */
+      }
+      continue;
+    }
+
+    /* 先頭の分岐先を空き要素に合わせる Base値は1以上 */
+    if (i_empty > i_first_label) {
+      i_base_value = i_empty - i_first_label;
+      if ((i_array_size_ <= i_base_value + i_last_label)
+      &&  (baseCheckExtendMemory(i_base_value + i_last_label + 1))) {
+        return I_FAILED_MEMORY;
+      }
+
+      int i(1);
+      while ((i < i_label_count) && (i_check_[i_base_value + c_labels[i]] == I_ARRAY_NO_DATA)) {
+        ++i;
+      }
+      if (i == i_label_count)
+        break;
+    }
+    i_empty = empty_slots.next(i_empty);
+  }
+
+  for (int i = 0; i < i_label_count; ++i) {
+    empty_slots.use(i_base_value + c_labels[i]);
+  }
+
+  return I_NO_ERROR;
+}
+
+
+/* Tailに情報を設定する                 */
+/* @param i_tail_index Tail格納開始位置 */
+/* @param node_parts   NodeParts        */
+/* @return Error code                   */
+int DoubleArray::setTailInfo(
+  int& i_tail_index,
+  const NodeParts* node_parts) noexcept
+{
+  if ((i_tail_size_ <= i_tail_index + node_parts->i_tail_size_)
+  &&  (tailExtendMemory(i_tail_index + node_parts->i_tail_size_))) { /* メモリが不足したので拡張 */
+    return I_FAILED_MEMORY;
+  }
+
+  if (node_parts->c_tail_) {
+    memcpy(&c_tail_[i_tail_index], node_parts->c_tail_, node_parts->i_tail_size_);
+    i_tail_index += static_cast<int>(node_parts->i_tail_size_);
+    --i_tail_index;
+  } else {
+    c_tail_[i_tail_index] = C_TAIL_CHAR;
+  }
+
+  i_result_[i_tail_index++] = node_parts->i_result_;
+
+  return I_NO_ERROR;
+}
+
+
+/* 重複Index情報作成                    */
+/* @param i_max_length 最長データ長     */
+/* @param positions    start,tail Index */
+/* @param datas        全追加データ     */
+/* @param i_data_count データ数         */
+void DoubleArray::createOverlapPositions(
+  uint64_t& i_max_length,
+  vector<pair<uint64_t, uint64_t>>& positions,
+  const ByteArray* datas,
+  const uint64_t i_data_count) const noexcept
+{
+  if (i_data_count == 1) {
+    i_max_length = datas[0].i_byte_length_;
+    return;
+  }
+
+  auto sameIndex = [](uint64_t& i_result, const uint64_t i_length, const char* c_first, const char* c_second) {
+    for (uint64_t i = 0; i < i_length; ++i) {
+      if (c_first[i] != c_second[i]) {
+        i_result = i;
+        break;
+      }
+    }
+  };
+
+  /* 先頭 */
+  const auto top  = &datas[0];
+  const auto next = &datas[1];
+  i_max_length = top->i_byte_length_;
+  uint64_t i_top_same_index(top->i_byte_length_);
+  sameIndex(i_top_same_index, top->i_byte_length_, top->c_byte_, next->c_byte_);
+  if (i_top_same_index == next->i_byte_length_) positions.begin()->first = numeric_limits<uint64_t>::max();
+  else                                          positions.begin()->second = i_top_same_index;
+
+  /* 先頭末尾を除く 重複データの間は直前の異なるデータとの一致長を引き継ぐ */
+  uint64_t i_before_same_index(positions.begin()->first ? 0 : i_top_same_index);
+  for (uint64_t i = 1, i_last = i_data_count - 1; i < i_last; ++i) {
+    const auto& current = datas[i];
+    const auto& after   = datas[i+1];
+    const char* c_current_byte = current.c_byte_;
+    uint64_t i_after_same_index(current.i_byte_length_);
+    if (i_max_length < i_after_same_index) {
+      i_max_length = i_after_same_index;
+    }
+
+    sameIndex(i_after_same_index, current.i_byte_length_, c_current_byte, after.c_byte_);
+    if (i_after_same_index == after.i_byte_length_) {
+      positions[i].first = numeric_limits<uint64_t>::max();  /* 同一データ混在 */
+    } else {
+      positions[i].first  = i_before_same_index;
+      positions[i].second = (i_before_same_index < i_after_same_index ? i_after_same_index : i_before_same_index);
+      i_before_same_index = i_after_same_index;
+    }
+  }
+
+  /* 末尾 */
+  const auto last = &datas[i_data_count - 1];
+  auto& last_position  = *positions.rbegin();
+  last_position.first  = i_before_same_index;
+  last_position.second = i_before_same_index;
+  if (i_max_length < last->i_byte_length_) {
+    i_max_length = last->i_byte_length_;
+  }
+}
+
+
+/* 検索する                                       */
+/* c_byteにはNULLが途中に含まれる可能性がある為、 */
+/* バイト長も渡さないとダメ。                     */
+/* 引数のバイト列末尾のNULLも使用する             */
+/* @param c_byte        search bytes              */
+/* @param i_byte_length search data length        */
+/* @return search result                          */
+int64_t DoubleArray::search(
+  const char* c_byte,
+  uint64_t i_byte_length) const noexcept
+{
+  if (units_)
+    return searchUnit(c_byte, i_byte_length);
+
+  uint64_t i(0);
+  int i_base_index(0), i_check_index(0);
+  for (; i <= i_byte_length; ++i) { /* 終端記号の分があるので<=とする */
+    i_check_index  = i_base_[i_base_index];
+    i_check_index += c_code_table_[static_cast<unsigned char>(c_byte[i])];
+    if (i_check_[i_check_index] != i_base_index) {
+      countLookup(i + 1, false, true, i);
+      return I_SEARCH_NOHIT;  /* データが存在しない */
+    }
+
+    if (i_base_[i_check_index] < 0) {
+      break;
+    }
+    i_base_index = i_check_index;
+  }
+
+  /* Tail処理 Tail突入契機のマイナス値をプラスに変換 */
+  const int64_t result(searchTail(-i_base_[i_check_index], c_byte, i, i_byte_length));
+  countLookup(i + 1, (i < i_byte_length), (result == I_SEARCH_NOHIT), i);
+
+  return result;
+}
+
+
+/* I_KEY_IDで構築したDoubleArrayからKey IDを取得する */
+/* @param c_byte        search bytes                 */
+/* @param i_byte_length search data length           */
+/* @return Key ID  -1 : 該当無し                     */
+int64_t DoubleArray::searchKeyId(
+  const char* c_byte,
+  const uint64_t i_byte_length) const noexcept
+{
+  return search(c_byte, i_byte_length) - 1;  /* I_SEARCH_NOHITは-1になる */
+}
+
+
+/* Unit形式で検索する                      */
+/* 1回の遷移で参照するのはUnit1つだけ      */
+/* @param c_byte        search bytes       */
+/* @param i_byte_length search data length */
+/* @return search result                   */
+int64_t DoubleArray::searchUnit(
+  const char* c_byte,
+  const uint64_t i_byte_length) const noexcept
+{
+  uint64_t i(0);
+  int i_base_index(0), i_base_value(units_[0].i_base_);
+  for (; i <= i_byte_length; ++i) { /* 終端記号の分があるので<=とする */
+    const int i_check_index(i_base_value + c_code_table_[static_cast<unsigned char>(c_byte[i])]);
+    const DAUnit& unit = units_[i_check_index];
+    if (unit.i_check_ != i_base_index) {
+      countLookup(i + 1, false, true, i);
+      return I_SEARCH_NOHIT;  /* データが存在しない */
+    }
+
+    i_base_value = unit.i_base_;
+    if (i_base_value < 0) {
+      break;
+    }
+    i_base_index = i_check_index;
+  }
+
+  const int64_t result(searchTail(-i_base_value, c_byte, i, i_byte_length));
+  countLookup(i + 1, (i < i_byte_length), (result == I_SEARCH_NOHIT), i);
+
+  return result;
+}
+
+
+/* 検索のTail処理                              */
+/* @param i_tail_index  Tail開始Index          */
+/* @param c_byte        search bytes           */
+/* @param i_byte_index  Tail突入契機のByte位置 */
+/* @param i_byte_length search data length     */
+/* @return search result                       */
+int64_t DoubleArray::searchTail(
+  const uint64_t i_tail_index,
+  const char* c_byte,
+  uint64_t i_byte_index,
+  const uint64_t i_byte_length) const noexcept
+{
+  if (i_byte_index < i_byte_length) {
+    ++i_byte_index;
+    uint64_t i_compare_length(i_byte_length - i_byte_index);
+    if (memcmp(&c_tail_[i_tail_index], &c_byte[i_byte_index], i_compare_length + 1) == 0) {
+      return getTailResult(i_tail_index + i_compare_length);
+    }
+  } else if (i_byte_index == i_byte_length) {
+    return getTailResult(i_tail_index);
+  }
+
+  return I_SEARCH_NOHIT;
+}
+
+
+/* 複数データを一括で検索する                   */
+/* @param c_bytes        search bytes配列       */
+/* @param i_byte_lengths search data length配列 */
+/* @param i_count        検索データ数           */
+/* @param results        search result配列      */
+void DoubleArray::searchBatch(
+  const char* const* c_bytes,
+  const uint64_t* i_byte_lengths,
+  const uint64_t i_count,
+  int64_t* results) const noexcept
+{
+  if (!checkInit()) {
+    fill(results, results + i_count, I_SEARCH_NOHIT);
+    return;
+  }
+
+  int      i_nodes[I_BATCH_WIDTH];     /* 遷移元BaseCheckIndex  Tail突入後はI_ARRAY_NO_DATA */
+  int      i_nexts[I_BATCH_WIDTH];     /* 遷移先BaseCheckIndex  Tail突入後はTailIndex       */
+  uint64_t i_positions[I_BATCH_WIDTH]; /* 遷移に使用したByte位置                           */
+  int      i_lanes[I_BATCH_WIDTH];     /* 検索途中のデータ                                 */
+
+  for (uint64_t i_top = 0; i_top < i_count; i_top += I_BATCH_WIDTH) {
+    const char* const* c_group_bytes  = c_bytes        + i_top;
+    const uint64_t* i_group_lengths   = i_byte_lengths + i_top;
+    int64_t* group_results            = results        + i_top;
+    auto getByte = [&](const int i_lane, const uint64_t i_position) -> int {
+      return (i_position < i_group_lengths[i_lane] ? getCode(c_group_bytes[i_lane][i_position]) : C_TAIL_CHAR);
+    };
+
+    int i_active(static_cast<int>(min<uint64_t>(I_BATCH_WIDTH, i_count - i_top)));
+    for (int i_lane = 0; i_lane < i_active; ++i_lane) {
+      i_nodes[i_lane]     = 0;
+      i_positions[i_lane] = 0;
+      i_nexts[i_lane]     = getBase(0) + getByte(i_lane, 0);
+      i_lanes[i_lane]     = i_lane;
+      prefetchNode(i_nexts[i_lane]);
+    }
+
+    while (i_active) {
+      int i_alive(0);
+      for (int i = 0; i < i_active; ++i) {
+        const int i_lane(i_lanes[i]);
+        const uint64_t i_position(i_positions[i_lane]);
+        const uint64_t i_byte_length(i_group_lengths[i_lane]);
+
+        if (i_nodes[i_lane] == I_ARRAY_NO_DATA) {  /* Tail処理 */
+          const uint64_t i_tail_index(i_nexts[i_lane]);
+          if (i_position < i_byte_length) {
+            const uint64_t i_compare_length(i_byte_length - i_position - 1);
+            if ((memcmp(&c_tail_[i_tail_index], &c_group_bytes[i_lane][i_position + 1], i_compare_length) == 0)
+            &&  (c_tail_[i_tail_index + i_compare_length] == C_TAIL_CHAR)) {
+              group_results[i_lane] = getTailResult(i_tail_index + i_compare_length);
+            } else {
+              group_results[i_lane] = I_SEARCH_NOHIT;
+            }
+          } else {
+            group_results[i_lane] = getTailResult(i_tail_index);
+          }
+          continue;
+        }
+
+        const int i_check_index(i_nexts[i_lane]);
+        if (getCheck(i_check_index) != i_nodes[i_lane]) {
+          group_results[i_lane] = I_SEARCH_NOHIT;  /* データが存在しない */
+          continue;
+        }
+
+        const int i_base_value(getBase(i_check_index));
+        if (i_base_value < 0) {  /* Tail突入 比較は次の周回で行う */
+          i_nodes[i_lane] = I_ARRAY_NO_DATA;
+          i_nexts[i_lane] = -i_base_value;
+          __builtin_prefetch(&c_tail_[-i_base_value]);
+        } else if (i_position >= i_byte_length) {
+          group_results[i_lane] = I_SEARCH_NOHIT;  /* 終端記号の後に続きは無い */
+          continue;
+        } else {
+          i_nodes[i_lane]     = i_check_index;
+          i_positions[i_lane] = i_position + 1;
+          i_nexts[i_lane]     = i_base_value + getByte(i_lane, i_position + 1);
+          prefetchNode(i_nexts[i_lane]);
+        }
+        i_lanes[i_alive++] = i_lane;
+      }
+      i_active = i_alive;
+    }
+  }
+}
+
+
+/* 途中経過状態を取得しながら検索する            */
+/* @param sarch_parts   search position          */
+/* @param result        search result            */
+/* @param c_byte        search bytes             */
+/* @param i_byte_length search data length       */
+/* @return true : 続きがある  false : 続きが無い */
+bool DoubleArray::searchContinue(
+  DASearchParts& search_parts,
+  int64_t& result,
+  const char* c_byte,
+  const uint64_t i_byte_length) const noexcept
+{
+  result = I_SEARCH_NOHIT;
+
+  uint64_t i(0), i_byte_index(0);
+  if (search_parts.i_tail_ == 0) {  /* Tailまで進んでいない */
+    for (; i < i_byte_length; ++i) {
+      search_parts.i_check_ = getBase(search_parts.i_base_) + getCode(c_byte[i]);
+      if (getCheck(search_parts.i_check_) != search_parts.i_base_) {
+        return false; /* データが存在しない */
+      }
+
+      if (getBase(search_parts.i_check_) < 0) {
+        i_byte_index = i + 1;
+        search_parts.i_tail_ = -getBase(search_parts.i_check_); /* マイナス値をプラスに変換 */
+        break;
+      }
+      search_parts.i_base_ = search_parts.i_check_;
+    }
+
+    if (i >= i_byte_length) {  /* Node上で止まった Tailは参照しない */
+      const int i_terminal_index(getBase(search_parts.i_base_) + C_TAIL_CHAR);
+      if ((getCheck(i_terminal_index) == search_parts.i_base_) && (getBase(i_terminal_index) < 0)) {
+        result = getTailResult(-getBase(i_terminal_index)); /* ヒット */
+      }
+      return true;
+    }
+  }
+
+  /* Tail処理 Tail終端記号を越えて比較しない */
+  const uint64_t i_compare_size(i_byte_length - i_byte_index);
+  for (uint64_t i_compare = 0; i_compare < i_compare_size; ++i_compare) {
+    if ((c_tail_[search_parts.i_tail_ + i_compare] == C_TAIL_CHAR)
+    ||  (c_tail_[search_parts.i_tail_ + i_compare] != c_byte[i_byte_index + i_compare]))
+      return false;  /* データが存在しない　Tailの途中で不一致 */
+  }
+
+  i_byte_index         += i_compare_size;
+  search_parts.i_tail_ += static_cast<int>(i_compare_size);
+
+  if (i_byte_index >= i_byte_length) {
+    if (c_tail_[search_parts.i_tail_] == C_TAIL_CHAR) {
+      result = getTailResult(search_parts.i_tail_);  /* ヒット */
+    } else {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+
+/* Rootに置く                          */
+/* @param double_array 辿るDoubleArray */
+DACursor::DACursor(
+  const DoubleArray& double_array) noexcept
+  : double_array_(double_array)
+{
+  reset();
+}
+
+
+/* Rootに戻す */
+void DACursor::reset() noexcept
+{
+  state_ = (double_array_.checkInit() ? DACursorState(0, 0, 0) : DACursorState());
+}
+
+
+/* 1Byte進める                                           */
+/* Tail中はTail位置を1つ進めるだけで済む                 */
+/* @param c_byte 次のByte                                */
+/* @return true : この位置までを接頭辞に持つデータがある */
+bool DACursor::step(
+  const char c_byte) noexcept
+{
+  if ((state_.i_node_ == DoubleArray::I_ARRAY_NO_DATA) || (c_byte == DoubleArray::C_TAIL_CHAR)) {
+    state_.i_node_ = DoubleArray::I_ARRAY_NO_DATA;  /* 終端記号はデータに含まれない */
+    return false;
+  }
+
+  if (state_.i_tail_) {
+    if (double_array_.c_tail_[state_.i_tail_] != c_byte) {
+      state_.i_node_ = DoubleArray::I_ARRAY_NO_DATA;
+      return false;
+    }
+    ++state_.i_tail_;
+    ++state_.i_depth_;
+    return true;
+  }
+
+  const int i_check_index(double_array_.getBase(state_.i_node_) + double_array_.getCode(c_byte));
+  if (double_array_.getCheck(i_check_index) != state_.i_node_) {
+    state_.i_node_ = DoubleArray::I_ARRAY_NO_DATA;
+    return false;
+  }
+
+  state_.i_node_ = i_check_index;
+  if (double_array_.getBase(i_check_index) < 0) {
+    state_.i_tail_ = -double_array_.getBase(i_check_index);  /* 以降はTailで照合する */
+  }
+  ++state_.i_depth_;
+
+  return true;
+}
+
+
+/* 複数Byte進める                                        */
+/* @param c_byte        次のByte列                       */
+/* @param i_byte_length Byte長                           */
+/* @return true : この位置までを接頭辞に持つデータがある */
+bool DACursor::step(
+  const char* c_byte,
+  const uint64_t i_byte_length) noexcept
+{
+  for (uint64_t i = 0; i < i_byte_length; ++i) {
+    if (!step(c_byte[i]))
+      return false;
+  }
+
+  return isValid();
+}
+
+
+/* ここまでのByte列が登録データかチェック */
+/* @return true : 登録データ              */
+bool DACursor::isTerminal() const noexcept
+{
+  if (state_.i_node_ == DoubleArray::I_ARRAY_NO_DATA)
+    return false;
+
+  if (state_.i_tail_)
+    return (double_array_.c_tail_[state_.i_tail_] == DoubleArray::C_TAIL_CHAR);
+
+  return (getTerminalTail() != 0);
+}
+
+
+/* ここまでのByte列の検索結果を取得する            */
+/* @return search result 登録データでなければNOHIT */
+int64_t DACursor::value() const noexcept
+{
+  if (!isTerminal())
+    return DoubleArray::I_SEARCH_NOHIT;
+
+  return double_array_.getTailResult(state_.i_tail_ ? state_.i_tail_ : getTerminalTail());
+}
+
+
+/* 次に進めるByteを昇順に求める                   */
+/* @param c_labels 次のByte 256要素分の領域が必要 */
+/* @return 次のByteの数                           */
+uint64_t DACursor::children(
+  unsigned char* c_labels) const noexcept
+{
+  if (state_.i_node_ == DoubleArray::I_ARRAY_NO_DATA)
+    return 0;
+
+  if (state_.i_tail_) {
+    const char c_next(double_array_.c_tail_[state_.i_tail_]);
+    if (c_next == DoubleArray::C_TAIL_CHAR)
+      return 0;
+    c_labels[0] = static_cast<unsigned char>(c_next);
+    return 1;
+  }
+
+  uint64_t i_count(0);
+  const int i_base_value(double_array_.getBase(state_.i_node_));
+  for (int i_byte = 1; i_byte <= 0xff; ++i_byte) {  /* 終端記号は子に含めない */
+    if (double_array_.getCheck(i_base_value + double_array_.c_code_table_[i_byte]) == state_.i_node_) {
+      c_labels[i_count++] = static_cast<unsigned char>(i_byte);
+    }
+  }
+
+  return i_count;
+}
+
+
+/* 現在のNodeから終端記号で遷移したLeaf */
+/* @return Tail終端記号の位置  0 : 無し */
+uint64_t DACursor::getTerminalTail() const noexcept
+{
+  const int i_terminal_index(double_array_.getBase(state_.i_node_) + DoubleArray::C_TAIL_CHAR);
+  if ((double_array_.getCheck(i_terminal_index) != state_.i_node_)
+  ||  (double_array_.getBase(i_terminal_index) >= 0))
+    return 0;
+
+  return -double_array_.getBase(i_terminal_index);
+}
+
+
+/* 共通接頭辞検索                                        */
+/* @param c_byte        search bytes                     */
+/* @param i_byte_length search data length               */
+/* @param results       一致したデータの検索結果と一致長 */
+/* @param i_max_results resultsに格納する最大数          */
+/* @return 一致したデータ数                              */
+uint64_t DoubleArray::commonPrefixSearch(
+  const char* c_byte,
+  const uint64_t i_byte_length,
+  DAPrefixResult* results,
+  const uint64_t i_max_results) const noexcept
+{
+  if (!checkInit())
+    return 0;
+
+  uint64_t i_count(0);
+  auto addResult = [&](const uint64_t i_tail_index, const uint64_t i_length) {
+    if (i_count < i_max_results) {
+      results[i_count] = DAPrefixResult(getTailResult(i_tail_index), i_length);
+    }
+    ++i_count;
+  };
+
+  int i_base_index(0);
+  for (uint64_t i = 0; ; ++i) {
+    /* 終端記号へ遷移できればここまでが登録データ */
+    const int i_terminal_index(getBase(i_base_index) + C_TAIL_CHAR);
+    if ((getCheck(i_terminal_index) == i_base_index)
+    &&  (getBase(i_terminal_index) < 0)
+    &&  (c_tail_[-getBase(i_terminal_index)] == C_TAIL_CHAR)) {
+      addResult(-getBase(i_terminal_index), i);
+    }
+
+    if (i >= i_byte_length)
+      break;
+
+    const int i_check_index(getBase(i_base_index) + getCode(c_byte[i]));
+    if (getCheck(i_check_index) != i_base_index)
+      break;  /* 続きのデータが存在しない */
+
+    if (getBase(i_check_index) < 0) {
+      /* Tail処理 Tail以降は1データのみなので全て一致すれば終了 */
+      const uint64_t i_tail_top(-getBase(i_check_index));
+      uint64_t i_tail_index(i_tail_top), i_byte_index(i + 1);
+      while ((c_tail_[i_tail_index] != C_TAIL_CHAR)
+      &&     (i_byte_index < i_byte_length)
+      &&     (c_tail_[i_tail_index] == c_byte[i_byte_index])) {
+        ++i_tail_index;
+        ++i_byte_index;
+      }
+
+      /* 終端記号での遷移は上で追加済み */
+      if ((c_tail_[i_tail_index] == C_TAIL_CHAR)
+      &&  ((c_byte[i] != C_TAIL_CHAR) || (i_tail_index != i_tail_top))) {
+        addResult(i_tail_index, i_byte_index);
+      }
+      break;
+    }
+    i_base_index = i_check_index;
+  }
+
+  return i_count;
+}
+
+
+/* c_byteの先頭に一致する最長のデータを求める */
+/* @param i_length      一致したバイト長      */
+/* @param result        search result         */
+/* @param c_byte        search bytes          */
+/* @param i_byte_length search data length    */
+/* @return true : 一致するデータ有り          */
+bool DoubleArray::searchLongest(
+  uint64_t& i_length,
+  int64_t& result,
+  const char* c_byte,
+  const uint64_t i_byte_length) const noexcept
+{
+  bool b_found(false);
+  int i_base_index(0);
+  for (uint64_t i = 0; ; ++i) {
+    /* 終端記号へ遷移できればここまでが登録データ */
+    const int i_terminal_index(getBase(i_base_index) + C_TAIL_CHAR);
+    if ((i) && (getCheck(i_terminal_index) == i_base_index)
+    &&  (getBase(i_terminal_index) < 0)
+    &&  (c_tail_[-getBase(i_terminal_index)] == C_TAIL_CHAR)) {
+      b_found  = true;
+      i_length = i;
+      result   = getTailResult(-getBase(i_terminal_index));
+    }
+
+    if (i >= i_byte_length)
+      break;
+
+    const int i_check_index(getBase(i_base_index) + getCode(c_byte[i]));
+    if ((c_byte[i] == C_TAIL_CHAR) || (getCheck(i_check_index) != i_base_index))
+      break;  /* 続きのデータが存在しない */
+
+    if (getBase(i_check_index) < 0) {
+      /* Tail処理 Tailの終端まで一致した場合のみ登録データ */
+      uint64_t i_tail_index(-getBase(i_check_index)), i_byte_index(i + 1);
+      while ((c_tail_[i_tail_index] != C_TAIL_CHAR)
+      &&     (i_byte_index < i_byte_length)
+      &&     (c_tail_[i_tail_index] == c_byte[i_byte_index])) {
+        ++i_tail_index;
+        ++i_byte_index;
+      }
+
+      if (c_tail_[i_tail_index] == C_TAIL_CHAR) {
+        b_found  = true;
+        i_length = i_byte_index;
+        result   = getTailResult(i_tail_index);
+      }
+      break;
+    }
+    i_base_index = i_check_index;
+  }
+
+  return b_found;
+}
+
+
+/* テキストを先頭から最長一致するデータで区切る */
+/* @param c_text        区切るテキスト          */
+/* @param i_text_length テキストのバイト長      */
+/* @param tokens        区切ったToken           */
+/* @param i_max_tokens  tokensに格納する最大数  */
+/* @return tokensに格納したToken数              */
+uint64_t DoubleArray::tokenizeLongest(
+  const char* c_text,
+  const uint64_t i_text_length,
+  DAToken* tokens,
+  const uint64_t i_max_tokens) const noexcept
+{
+  uint64_t i_count(0), i_unknown_begin(0), i_offset(0);
+  bool b_unknown(false);
+  const bool b_init(checkInit());
+  while ((i_offset < i_text_length) && (i_count < i_max_tokens)) {
+    uint64_t i_length(0);
+    int64_t result(I_SEARCH_NOHIT);
+    if ((b_init) && (searchLongest(i_length, result, c_text + i_offset, i_text_length - i_offset))) {
+      if (b_unknown) {  /* 未知のByte列を先に出力 */
+        tokens[i_count++] = DAToken(i_unknown_begin, i_offset - i_unknown_begin, I_SEARCH_NOHIT);
+        b_unknown = false;
+        if (i_count >= i_max_tokens)
+          break;
+      }
+      tokens[i_count++] = DAToken(i_offset, i_length, result);
+      i_offset += i_length;
+    } else {
+      if (!b_unknown) {
+        i_unknown_begin = i_offset;
+        b_unknown       = true;
+      }
+      ++i_offset;
+    }
+  }
+
+  if ((b_unknown) && (i_count < i_max_tokens)) {
+    tokens[i_count++] = DAToken(i_unknown_begin, i_offset - i_unknown_begin, I_SEARCH_NOHIT);
+  }
+
+  return i_count;
+}
+
+
+/* 予測検索を開始する                          */
+/* @param predictive_parts 列挙状態            */
+/* @param c_byte           接頭辞              */
+/* @param i_byte_length    接頭辞の長さ        */
+/* @param i_max_results    列挙する最大数      */
+/* @return true : 接頭辞に一致するデータがある */
+bool DoubleArray::predictiveSearch(
+  DAPredictiveParts& predictive_parts,
+  const char* c_byte,
+  const uint64_t i_byte_length,
+  const uint64_t i_max_results) const noexcept
+{
+  predictive_parts.init();
+  if (!checkInit() || i_max_results == 0)
+    return false;
+
+  predictive_parts.c_key_.assign(c_byte, c_byte + i_byte_length);
+  predictive_parts.i_prefix_length_ = i_byte_length;
+  predictive_parts.i_remain_        = i_max_results;
+
+  int i_base_index(0);
+  for (uint64_t i = 0; i < i_byte_length; ++i) {
+    const int i_check_index(getBase(i_base_index) + getCode(c_byte[i]));
+    if (getCheck(i_check_index) != i_base_index)
+      return false;  /* 接頭辞が存在しない */
+
+    if (getBase(i_check_index) < 0) {
+      /* Tail以降は1データのみ 接頭辞の残りがTailと一致すれば列挙対象 */
+      uint64_t i_tail_index(-getBase(i_check_index));
+      if ((c_byte[i] == C_TAIL_CHAR) && (c_tail_[i_tail_index] == C_TAIL_CHAR))
+        return false;  /* 終端記号での遷移 */
+
+      for (++i; i < i_byte_length; ++i, ++i_tail_index) {
+        if ((c_tail_[i_tail_index] == C_TAIL_CHAR)
+        ||  (c_tail_[i_tail_index] != c_byte[i]))
+          return false;
+      }
+      while (c_tail_[i_tail_index] != C_TAIL_CHAR) {
+        predictive_parts.c_key_.push_back(c_tail_[i_tail_index++]);
+      }
+      predictive_parts.i_tail_index_ = i_tail_index;
+      return true;
+    }
+    i_base_index = i_check_index;
+  }
+
+  predictive_parts.i_nodes_.emplace_back(i_base_index, 0);
+  return true;
+}
+
+
+/* 予測検索の次のデータを取得する              */
+/* @param predictive_parts 列挙状態            */
+/* @param result           search result       */
+/* @return true : 取得できた  false : 列挙終了 */
+bool DoubleArray::predictiveNext(
+  DAPredictiveParts& predictive_parts,
+  int64_t& result) const noexcept
+{
+  result = I_SEARCH_NOHIT;
+  if (predictive_parts.i_remain_ == 0)
+    return false;
+
+  if (predictive_parts.i_tail_index_) {  /* 接頭辞がTail内で一致 */
+    result = getTailResult(predictive_parts.i_tail_index_);
+    predictive_parts.i_tail_index_ = 0;
+    predictive_parts.i_remain_     = 0;
+    return true;
+  }
+
+  auto& nodes = predictive_parts.i_nodes_;
+  auto& keys  = predictive_parts.c_key_;
+  while (!nodes.empty()) {
+    auto& node = nodes.back();
+    const int i_base_index(node.first);
+    const int i_base_value(getBase(i_base_index));
+    int i_byte(node.second);
+    while ((i_byte <= 0xff) && (getCheck(i_base_value + c_code_table_[i_byte]) != i_base_index)) {
+      ++i_byte;
+    }
+    if (i_byte > 0xff) {  /* このNodeの分岐は全て列挙済み */
+      nodes.pop_back();
+      continue;
+    }
+    node.second = i_byte + 1;
+
+    keys.resize(predictive_parts.i_prefix_length_ + nodes.size() - 1);
+    const int i_check_index(i_base_value + c_code_table_[i_byte]);
+    if (getBase(i_check_index) >= 0) {
+      keys.push_back(static_cast<char>(i_byte));
+      nodes.emplace_back(i_check_index, 0);
+      continue;
+    }
+
+    /* Tail処理 終端記号での遷移は終端記号自体をByte情報に含めない */
+    uint64_t i_tail_index(-getBase(i_check_index));
+    if ((i_byte != C_TAIL_CHAR) || (c_tail_[i_tail_index] != C_TAIL_CHAR)) {
+      keys.push_back(static_cast<char>(i_byte));
+    }
+    while (c_tail_[i_tail_index] != C_TAIL_CHAR) {
+      keys.push_back(c_tail_[i_tail_index++]);
+    }
+    result = getTailResult(i_tail_index);
+    --predictive_parts.i_remain_;
+    return true;
+  }
+
+  return false;
+}
+
+
+/* 編集距離がi_max_edits以内の全てのデータを辞書順に求める */
+/* @param c_byte        search bytes                       */
+/* @param i_byte_length search data length                 */
+/* @param i_max_edits   許容する編集距離                   */
+/* @param found         見つかったデータを受け取る関数     */
+/* @return foundを呼び出した回数                           */
+uint64_t DoubleArray::fuzzySearch(
+  const char* c_byte,
+  const uint64_t i_byte_length,
+  const uint64_t i_max_edits,
+  const FuzzyFunction& found) const noexcept
+{
+  if (!checkInit())
+    return 0;
+
+  /* 表の1行目は空のByte列との距離 */
+  const uint64_t i_row_width(i_byte_length + 1);
+  vector<uint64_t> i_rows(i_row_width);
+  for (uint64_t i = 0; i < i_row_width; ++i) {
+    i_rows[i] = i;
+  }
+
+  uint64_t i_found(0);
+  vector<char> c_key;
+  vector<pair<int, int>> nodes;  /* Nodeと次に調べるByte */
+  nodes.emplace_back(0, 0);
+  while (!nodes.empty()) {
+    auto& node = nodes.back();
+    const int i_base_index(node.first);
+    const int i_base_value(getBase(i_base_index));
+
+    /* 表とByte情報をこのNodeの深さまで戻す */
+    const uint64_t i_depth(nodes.size() - 1);
+    c_key.resize(i_depth);
+    i_rows.resize((i_depth + 1) * i_row_width);
+    const uint64_t* i_row(i_rows.data() + i_depth * i_row_width);
+
+    int i_byte(node.second);
+    if (*min_element(i_row, i_row + i_row_width) < i_max_edits) {
+      while ((i_byte <= 0xff) && (getCheck(i_base_value + c_code_table_[i_byte]) != i_base_index)) {
+        ++i_byte;
+      }
+    } else {
+      /* 距離に余裕が無いNodeは、検索Byte列と一致するByteか終端でしか上限以内に留まれない */
+      int i_next(0x100);
+      if ((i_byte == 0) && (i_row[i_byte_length] <= i_max_edits) && (getCheck(i_base_value) == i_base_index))
+        i_next = 0;
+      for (uint64_t i = 0; i < i_byte_length; ++i) {
+        const int i_label(static_cast<unsigned char>(c_byte[i]));
+        if ((i_row[i] <= i_max_edits) && (i_label >= i_byte) && (i_label < i_next)
+        &&  (getCheck(i_base_value + c_code_table_[i_label]) == i_base_index)) {
+          i_next = i_label;
+        }
+      }
+      i_byte = i_next;
+    }
+    if (i_byte > 0xff) {  /* このNodeの分岐は全て探索済み */
+      nodes.pop_back();
+      continue;
+    }
+    node.second = i_byte + 1;
+
+    const int i_check_index(i_base_value + c_code_table_[i_byte]);
+    if (getBase(i_check_index) >= 0) {
+      c_key.push_back(static_cast<char>(i_byte));
+      if (appendFuzzyRow(i_rows, c_byte, i_byte_length, static_cast<char>(i_byte)) <= i_max_edits) {
+        nodes.emplace_back(i_check_index, 0);
+      }
+      continue;  /* 上限を超えた部分木は辿らない */
+    }
+
+    /* Tail処理 終端記号での遷移は終端記号自体をByte情報に含めない */
+    uint64_t i_tail_index(-getBase(i_check_index));
+    uint64_t i_min_distance(0);
+    if ((i_byte != C_TAIL_CHAR) || (c_tail_[i_tail_index] != C_TAIL_CHAR)) {
+      c_key.push_back(static_cast<char>(i_byte));
+      i_min_distance = appendFuzzyRow(i_rows, c_byte, i_byte_length, static_cast<char>(i_byte));
+    }
+    while ((i_min_distance <= i_max_edits) && (c_tail_[i_tail_index] != C_TAIL_CHAR)) {
+      c_key.push_back(c_tail_[i_tail_index]);
+      i_min_distance = appendFuzzyRow(i_rows, c_byte, i_byte_length, c_tail_[i_tail_index++]);
+    }
+    if ((i_min_distance > i_max_edits) || (i_rows.back() > i_max_edits))
+      continue;
+
+    ++i_found;
+    if (!found(c_key.data(), c_key.size(), i_rows.back(), getTailResult(i_tail_index)))
+      break;
+  }
+
+  return i_found;
+}
+
+
+/* 編集距離の表に1Byte分の行を追加する     */
+/* @param i_rows        編集距離の表       */
+/* @param c_byte        search bytes       */
+/* @param i_byte_length search data length */
+/* @param c_label       追加するByte       */
+/* @return 追加した行の最小値              */
+uint64_t DoubleArray::appendFuzzyRow(
+  vector<uint64_t>& i_rows,
+  const char* c_byte,
+  const uint64_t i_byte_length,
+  const char c_label) const noexcept
+{
+  const uint64_t i_row_width(i_byte_length + 1);
+  const uint64_t i_previous(i_rows.size() - i_row_width);
+  i_rows.resize(i_rows.size() + i_row_width);
+  const uint64_t* i_upper(i_rows.data() + i_previous);
+  uint64_t* i_current(i_rows.data() + i_previous + i_row_width);
+
+  i_current[0] = i_upper[0] + 1;
+  uint64_t i_min_distance(i_current[0]);
+  for (uint64_t i = 1; i < i_row_width; ++i) {
+    const uint64_t i_replace(i_upper[i - 1] + (c_byte[i - 1] != c_label ? 1 : 0));
+    i_current[i] = min(i_replace, min(i_upper[i], i_current[i - 1]) + 1);
+    i_min_distance = min(i_min_distance, i_current[i]);
+  }
+
+  return i_min_distance;
+}
+
+
+/* Tail終端位置から検索結果を取得する      */
+/* @param i_tail_index Tail終端記号のIndex */
+/* @return search result                   */
+int64_t DoubleArray::getTailResult(
+  const uint64_t i_tail_index) const noexcept
+{
+  if (i_result_)
+    return i_result_[i_tail_index];
+
+  return (result_blocks_ == nullptr ? I_HIT_DEFAULT : getCompactResult(i_tail_index));
+}
+
+
+/* Tail終端記号より前にある結果を持つ終端記号の数を求める */
+/* @param i_tail_index Tail終端記号のIndex                */
+/* @return 順位 0始まり                                   */
+uint64_t DoubleArray::getResultRank(
+  const uint64_t i_tail_index) const noexcept
+{
+  const auto& block = result_blocks_[i_tail_index / DAResultBlock::I_BLOCK_SIZE];
+  const uint64_t i_word((i_tail_index % DAResultBlock::I_BLOCK_SIZE) / 64);
+  uint64_t i_rank(block.i_rank_ + __builtin_popcountll(block.i_bits_[i_word] & ((1ULL << (i_tail_index % 64)) - 1)));
+  for (uint64_t i = 0; i < i_word; ++i) {
+    i_rank += __builtin_popcountll(block.i_bits_[i]);
+  }
+
+  return i_rank;
+}
+
+
+/* 詰めた結果配列から検索結果を取得する    */
+/* @param i_tail_index Tail終端記号のIndex */
+/* @return search result                   */
+int64_t DoubleArray::getCompactResult(
+  const uint64_t i_tail_index) const noexcept
+{
+  const uint64_t i_rank(getResultRank(i_tail_index));
+  if (i_packed_result_ == nullptr)
+    return static_cast<int64_t>(i_rank) + 1;  /* I_KEY_ID */
+
+  const uint64_t i_width(i_packed_result_[1]);
+  if (i_width == 0)
+    return static_cast<int64_t>(i_packed_result_[0]);
+
+  const uint64_t* i_words(i_packed_result_ + 2);
+  const uint64_t i_bit_position(i_rank * i_width);
+  uint64_t i_value(i_words[i_bit_position / 64] >> (i_bit_position % 64));
+  if (i_bit_position % 64 + i_width > 64) {
+    i_value |= i_words[i_bit_position / 64 + 1] << (64 - i_bit_position % 64);
+  }
+  if (i_width < 64) {
+    i_value &= (1ULL << i_width) - 1;
+  }
+
+  return static_cast<int64_t>(i_packed_result_[0] + i_value);
+}
+
+
+/* DoubleArray情報を書き込む                         */
+/* Sectionはヘッダ先頭からI_PAGE_SIZE単位で配置する  */
+/* @param i_write_size 書き込んだデータサイズ        */
+/* @param fp           OutputFileStream              */
+/* @return I_DA_NO_ERROR : 正常終了 0以外 : 異常終了 */
+int DoubleArray::writeBinary(
+  int64_t& i_write_size,
+  FILE* fp) const noexcept
+{
+  DAFileHeader header;
+  createFileHeader(header);
+  if (1 != fwrite(&header, sizeof(header), 1, fp))
+    return I_FAIELD_FILE_IO;
+
+  const char c_padding[I_PAGE_SIZE] = { 0 };
+  uint64_t i_position(sizeof(header));
+  for (int i = 0; i < DAFileHeader::I_SECTION_MAX; ++i) {
+    if (header.i_section_size_[i] == 0)
+      continue;
+
+    const uint64_t i_padding_size(header.i_section_offset_[i] - i_position);
+    if (((i_padding_size) && (1 != fwrite(c_padding, i_padding_size, 1, fp)))
+    ||  (1 != fwrite(getSectionData(i), header.i_section_size_[i], 1, fp)))
+      return I_FAIELD_FILE_IO;
+
+    i_position = header.i_section_offset_[i] + header.i_section_size_[i];
+  }
+
+  i_write_size += header.i_image_size_;
+
+  return I_NO_ERROR;
+}
+
+
+/* DoubleArray情報を読み込む                 */
+/* Version情報の無い旧形式も読み込める       */
+/* @param i_read_size 読み込んだデータサイズ */
+/* @param fp InputFileStream                 */
+/* @return 0 : 正常終了 0以外 : 異常終了     */
+int DoubleArray::readBinary(
+  int64_t& i_read_size,
+  FILE* fp) noexcept
+{
+  resetBuildStats();
+  uint64_t i_magic(0);
+  if (1 != fread(&i_magic, sizeof(i_magic), 1, fp)) {
+    deleteMemory();
+    return I_FAIELD_FILE_IO;
+  }
+
+  if (i_magic == I_FILE_MAGIC) {
+    DAFileHeader header;
+    header.i_magic_ = i_magic;
+    if (1 != fread(reinterpret_cast<char*>(&header) + sizeof(i_magic), sizeof(header) - sizeof(i_magic), 1, fp)) {
+      deleteMemory();
+      return I_FAIELD_FILE_IO;
+    }
+    return readSections(i_read_size, header, fp);
+  }
+
+  try {
+    i_array_size_ = i_magic;  /* 旧形式は先頭が配列サイズ */
+    i_option_     = I_NO_OPTION;
+
+    if (i_array_size_) {
+      if ((1 != fread(&i_tail_size_,   sizeof(i_tail_size_),   1, fp)) /* Tail文字列サイズ */
+      ||  (1 != fread(&i_result_size_, sizeof(i_result_size_), 1, fp)) /* Tail結果サイズ   */
+      ||  (keepMemory())) /* 配列サイズが確定したのでメモリ確保 */
+        throw I_FAIELD_FILE_IO;
+
+      if ((static_cast<size_t>(i_array_size_) != fread(i_base_,  sizeof(i_base_[0]),  i_array_size_, fp))   /* Base     */
+      ||  (static_cast<size_t>(i_array_size_) != fread(i_check_, sizeof(i_check_[0]), i_array_size_, fp))   /* Check    */
+      ||  (static_cast<size_t>(i_tail_size_)  != fread(c_tail_,  sizeof(c_tail_[0]),  i_tail_size_,  fp)))  /* Tail文字 */
+        throw I_FAIELD_FILE_IO;
+
+      if (i_result_size_) {
+        if (static_cast<size_t>(i_result_size_) != fread(i_result_, sizeof(i_result_[0]), i_result_size_, fp)) /* Tail結果 */
+          throw I_FAIELD_FILE_IO;
+      } else {
+        i_result_ = nullptr;
+      }
+
+      i_read_size += sizeof(i_tail_size_);
+      i_read_size += sizeof(i_result_size_);
+      i_read_size += sizeof(i_base_[0])  * i_array_size_;
+      i_read_size += sizeof(i_check_[0]) * i_array_size_;
+      if (i_result_size_) {
+        i_read_size += sizeof(i_result_[0]) * i_result_size_;
+      }
+    } else {
+      i_read_size += sizeof(i_array_size_);
+    }
+  } catch (...) {
+    deleteMemory();
+    return I_FAIELD_FILE_IO;
+  }
+
+  return I_NO_ERROR;
+}
+
+
+/* ヘッダ情報を基にサイズを設定してSection毎に読み込む */
+/* @param i_read_size 読み込んだデータサイズ           */
+/* @param header      読み込んだヘッダ情報             */
+/* @param fp          InputFileStream                  */
+/* @return Error Code                                  */
+int DoubleArray::readSections(
+  int64_t& i_read_size,
+  const DAFileHeader& header,
+  FILE* fp) noexcept
+{
+  deleteMemory();
+  if (header.i_version_ > I_FILE_VERSION)
+    return I_FAIELD_FILE_IO;
+
+  if (header.i_array_size_ == 0) {
+    i_read_size += header.i_image_size_;
+    return I_NO_ERROR;  /* 空のDoubleArray */
+  }
+
+  i_array_size_  = header.i_array_size_;
+  i_tail_size_   = header.i_tail_size_;
+  i_result_size_ = header.i_result_size_;
+  i_option_      = static_cast<int>(header.i_flags_);
+  if (keepMemory())
+    return I_FAILED_MEMORY;
+
+  i_reverse_size_ = header.i_section_size_[DAFileHeader::I_SECTION_REVERSE] / sizeof(DAReverseEntry);
+  i_packed_size_  = header.i_section_size_[DAFileHeader::I_SECTION_PACKED]  / sizeof(uint64_t);
+  if ((i_option_ & I_COMPACT_RESULT) && (i_packed_size_ < 2)) {
+    deleteMemory();
+    return I_FAIELD_FILE_IO;  /* 最小値とbit幅が無い */
+  }
+  try {
+    if (i_reverse_size_) {
+      reverse_index_ = new DAReverseEntry[i_reverse_size_];
+    }
+    if (i_option_ & (I_COMPACT_RESULT | I_KEY_ID)) {
+      result_blocks_ = new DAResultBlock[getSectionSize(DAFileHeader::I_SECTION_RANK) / sizeof(DAResultBlock)];
+    }
+    if (i_option_ & I_COMPACT_RESULT) {
+      i_packed_result_ = new uint64_t[i_packed_size_];
+    }
+  } catch (...) {
+    deleteMemory();
+    return I_FAILED_MEMORY;
+  }
+
+  uint64_t i_position(sizeof(header));
+  for (int i = 0; i < DAFileHeader::I_SECTION_MAX; ++i) {
+    if (header.i_section_size_[i] != getSectionSize(i)) {
+      deleteMemory();
+      return I_FAIELD_FILE_IO;  /* サイズ情報と不整合 */
+    }
+    if (header.i_section_size_[i] == 0)
+      continue;
+
+    if ((header.i_section_offset_[i] < i_position)
+    ||  (fseek(fp, static_cast<long>(header.i_section_offset_[i] - i_position), SEEK_CUR))
+    ||  (1 != fread(getSectionData(i), header.i_section_size_[i], 1, fp))) {
+      deleteMemory();
+      return I_FAIELD_FILE_IO;
+    }
+    i_position = header.i_section_offset_[i] + header.i_section_size_[i];
+  }
+
+  if ((i_option_ & I_CODE_TABLE) && !checkCodeTable()) {
+    deleteMemory();
+    return I_FAIELD_FILE_IO;
+  }
+
+  i_read_size += i_position;
+
+  return I_NO_ERROR;
+}
+
+
+/* writeBinaryで書き込んだファイルをmmapして検索可能にする */
+/* @param c_file_path   ファイルパス                       */
+/* @param i_file_offset writeBinaryの書き込み開始位置      */
+/* @return I_NO_ERROR : 正常終了 0以外 : 異常終了          */
+int DoubleArray::openMapped(
+  const char* c_file_path,
+  const uint64_t i_file_offset) noexcept
+{
+  deleteMemory();
+  resetBuildStats();
+  if (i_file_offset % sizeof(int64_t))
+    return I_FAIELD_FILE_IO;  /* 配列のAlignmentが保てない */
+
+  const int i_fd(open(c_file_path, O_RDONLY));
+  if (i_fd < 0)
+    return I_FAIELD_FILE_IO;
+
+  struct stat file_stat;
+  if ((fstat(i_fd, &file_stat) != 0)
+  ||  (static_cast<uint64_t>(file_stat.st_size) < i_file_offset + sizeof(DAFileHeader))) {
+    close(i_fd);
+    return I_FAIELD_FILE_IO;
+  }
+
+  /* mmapの開始位置はページ境界に合わせる */
+  const uint64_t i_page_size(static_cast<uint64_t>(sysconf(_SC_PAGESIZE)));
+  const uint64_t i_map_offset(i_file_offset / i_page_size * i_page_size);
+  const uint64_t i_map_size(static_cast<uint64_t>(file_stat.st_size) - i_map_offset);
+  void* p_mapped = mmap(nullptr, i_map_size, PROT_READ, MAP_SHARED, i_fd, static_cast<off_t>(i_map_offset));
+  close(i_fd);
+  if (p_mapped == MAP_FAILED)
+    return I_FAIELD_FILE_IO;
+
+  p_mapped_      = p_mapped;
+  i_mapped_size_ = i_map_size;
+
+  char* c_image = static_cast<char*>(p_mapped) + (i_file_offset - i_map_offset);
+  const uint64_t i_image_limit(i_map_size - (i_file_offset - i_map_offset));
+  DAFileHeader header;
+  memcpy(&header, c_image, sizeof(header));
+  if ((header.i_magic_   != I_FILE_MAGIC)
+  ||  (header.i_version_ >  I_FILE_VERSION)
+  ||  (header.i_image_size_ > i_image_limit)) {
+    deleteMemory();
+    return I_FAIELD_FILE_IO;
+  }
+
+  if (header.i_array_size_ == 0) {
+    deleteMemory();
+    return I_NO_ERROR;  /* 空のDoubleArray */
+  }
+
+  i_array_size_  = header.i_array_size_;
+  i_tail_size_   = header.i_tail_size_;
+  i_result_size_ = header.i_result_size_;
+  i_option_      = static_cast<int>(header.i_flags_);
+  i_reverse_size_ = header.i_section_size_[DAFileHeader::I_SECTION_REVERSE] / sizeof(DAReverseEntry);
+  i_packed_size_  = header.i_section_size_[DAFileHeader::I_SECTION_PACKED]  / sizeof(uint64_t);
+  if ((i_option_ & I_COMPACT_RESULT) && (i_packed_size_ < 2)) {
+    deleteMemory();
+    return I_FAIELD_FILE_IO;  /* 最小値とbit幅が無い */
+  }
+  for (int i = 0; i < DAFileHeader::I_SECTION_MAX; ++i) {
+    if ((header.i_section_size_[i] != getSectionSize(i))
+    ||  (header.i_section_offset_[i] + header.i_section_size_[i] > header.i_image_size_)) {
+      deleteMemory();
+      return I_FAIELD_FILE_IO;  /* サイズ情報と不整合 */
+    }
+    setSectionData(i, header.i_section_size_[i] ? c_image + header.i_section_offset_[i] : nullptr);
+  }
+
+  if ((i_option_ & I_CODE_TABLE) && !checkCodeTable()) {
+    deleteMemory();
+    return I_FAIELD_FILE_IO;
+  }
+
+  return I_NO_ERROR;
+}
+
+
+/* mmapした領域を参照しているかチェック              */
+/* @return true : mmap領域を参照  false : 自前で確保 */
+bool DoubleArray::checkMapped() const noexcept
+{
+  return p_mapped_ != nullptr;
+}
+
+
+/* Binary形式のヘッダ情報を作成する */
+/* @param header 作成したヘッダ情報 */
+void DoubleArray::createFileHeader(
+  DAFileHeader& header) const noexcept
+{
+  header.i_magic_   = I_FILE_MAGIC;
+  header.i_version_ = I_FILE_VERSION;
+  header.i_flags_   = static_cast<uint32_t>(i_option_);
+
+  uint64_t i_offset(sizeof(header));
+  if (checkInit()) {
+    header.i_array_size_  = i_array_size_;
+    header.i_tail_size_   = i_tail_size_;
+    header.i_result_size_ = i_result_size_;
+
+    for (int i = 0; i < DAFileHeader::I_SECTION_MAX; ++i) {
+      header.i_section_size_[i] = getSectionSize(i);
+      if (header.i_section_size_[i]) {
+        i_offset = (i_offset + I_PAGE_SIZE - 1) / I_PAGE_SIZE * I_PAGE_SIZE;
+        header.i_section_offset_[i] = i_offset;
+        i_offset += header.i_section_size_[i];
+      }
+    }
+  }
+
+  header.i_image_size_ = i_offset;
+}
+
+
+/* Sectionのバイトサイズを現在の各サイズから求める */
+/* @param i_section Section番号                    */
+/* @return バイトサイズ 0 : 該当Section無し        */
+uint64_t DoubleArray::getSectionSize(
+  const int i_section) const noexcept
+{
+  const bool b_unit(i_option_ & I_UNIT_LAYOUT);
+  switch (i_section) {
+  case DAFileHeader::I_SECTION_BASE:    return (b_unit ? 0 : sizeof(i_base_[0])  * i_array_size_);
+  case DAFileHeader::I_SECTION_CHECK:   return (b_unit ? 0 : sizeof(i_check_[0]) * i_array_size_);
+  case DAFileHeader::I_SECTION_TAIL:    return sizeof(c_tail_[0])   * i_tail_size_;
+  case DAFileHeader::I_SECTION_RESULT:  return sizeof(i_result_[0]) * i_result_size_;
+  case DAFileHeader::I_SECTION_UNIT:    return (b_unit ? sizeof(units_[0]) * i_array_size_ : 0);
+  case DAFileHeader::I_SECTION_REVERSE: return sizeof(DAReverseEntry) * i_reverse_size_;
+  case DAFileHeader::I_SECTION_RANK:    return ((i_option_ & (I_COMPACT_RESULT | I_KEY_ID)) ? sizeof(DAResultBlock) * ((i_tail_size_ + DAResultBlock::I_BLOCK_SIZE - 1) / DAResultBlock::I_BLOCK_SIZE) : 0);
+  case DAFileHeader::I_SECTION_PACKED:  return sizeof(i_packed_result_[0]) * i_packed_size_;
+  case DAFileHeader::I_SECTION_CODE:    return ((i_option_ & I_CODE_TABLE) ? sizeof(c_code_table_) : 0);
+  default:                              return 0;
+  }
+}
+
+
+/* Sectionに対応する配列を取得する                */
+/* @param i_section Section番号                   */
+/* @return 配列の先頭 該当配列が無い場合はnullptr */
+char* DoubleArray::getSectionData(
+  const int i_section) const noexcept
+{
+  switch (i_section) {
+  case DAFileHeader::I_SECTION_BASE:    return reinterpret_cast<char*>(i_base_);
+  case DAFileHeader::I_SECTION_CHECK:   return reinterpret_cast<char*>(i_check_);
+  case DAFileHeader::I_SECTION_TAIL:    return c_tail_;
+  case DAFileHeader::I_SECTION_RESULT:  return reinterpret_cast<char*>(i_result_);
+  case DAFileHeader::I_SECTION_UNIT:    return reinterpret_cast<char*>(units_);
+  case DAFileHeader::I_SECTION_REVERSE: return reinterpret_cast<char*>(reverse_index_);
+  case DAFileHeader::I_SECTION_RANK:    return reinterpret_cast<char*>(result_blocks_);
+  case DAFileHeader::I_SECTION_PACKED:  return reinterpret_cast<char*>(i_packed_result_);
+  case DAFileHeader::I_SECTION_CODE:    return reinterpret_cast<char*>(const_cast<unsigned char*>(c_code_table_));
+  default:                              return nullptr;
+  }
+}
+
+
+/* Sectionに対応する配列を設定する mmap領域の参照に使用 */
+/* @param i_section Section番号                         */
+/* @param c_data    配列の先頭                          */
+void DoubleArray::setSectionData(
+  const int i_section,
+  char* c_data) noexcept
+{
+  switch (i_section) {
+  case DAFileHeader::I_SECTION_BASE:    i_base_          = reinterpret_cast<int*>(c_data);            break;
+  case DAFileHeader::I_SECTION_CHECK:   i_check_         = reinterpret_cast<int*>(c_data);            break;
+  case DAFileHeader::I_SECTION_TAIL:    c_tail_          = c_data;                                    break;
+  case DAFileHeader::I_SECTION_RESULT:  i_result_        = reinterpret_cast<int64_t*>(c_data);        break;
+  case DAFileHeader::I_SECTION_UNIT:    units_           = reinterpret_cast<DAUnit*>(c_data);         break;
+  case DAFileHeader::I_SECTION_REVERSE: reverse_index_   = reinterpret_cast<DAReverseEntry*>(c_data); break;
+  case DAFileHeader::I_SECTION_RANK:    result_blocks_   = reinterpret_cast<DAResultBlock*>(c_data);  break;
+  case DAFileHeader::I_SECTION_PACKED:  i_packed_result_ = reinterpret_cast<uint64_t*>(c_data);       break;
+  case DAFileHeader::I_SECTION_CODE:    if (c_data) memcpy(c_code_table_, c_data, sizeof(c_code_table_)); break;
+  default:                                                                                            break;
+  }
+}
+
+
+/* 内部データを取得する                  */
+/* @param i_array_size  配列サイズ       */
+/* @param i_tail_size   Tail文字列サイズ */
+/* @param i_result_size Tail結果サイズ   */
+/* @param i_base        Base配列         */
+/* @param i_check       Check配列        */
+/* @param i_result      Tail結果配列     */
+/* @param c_tail        Tail文字配列     */
+void DoubleArray::getDoubleArrayData(
+  uint64_t& i_array_size,
+  uint64_t& i_tail_size,
+  uint64_t& i_result_size,
+  const int*& i_base,
+  const int*& i_check,
+  const int64_t*& i_result,
+  const char*& c_tail) const noexcept
+{
+  i_array_size  = i_array_size_;
+  i_tail_size   = i_tail_size_;
+  i_result_size = i_result_size_;
+  i_base        = i_base_;
+  i_check       = i_check_;
+  i_result      = i_result_;
+  c_tail        = c_tail_;
+}
+
+
+/* 内部データを外部から設定する          */
+/* @param i_array_size  配列サイズ       */
+/* @param i_tail_size   Tail文字列サイズ */
+/* @param i_result_size Tail結果サイズ   */
+/* @param i_base        Base配列         */
+/* @param i_check       Check配列        */
+/* @param i_result      Tail結果配列     */
+/* @param c_tail        Tail文字配列     */
+int DoubleArray::setDoubleArrayData(
+  uint64_t i_array_size,
+  uint64_t i_tail_size,
+  uint64_t i_result_size,
+  const int* i_base,
+  const int* i_check,
+  const int64_t* i_result,
+  const char* c_tail) noexcept
+{
+  i_array_size_  = i_array_size;  /* 配列サイズ       */
+  i_tail_size_   = i_tail_size;   /* Tail文字列サイズ */
+  i_result_size_ = i_result_size; /* Tail結果サイズ   */
+  i_option_      = I_NO_OPTION;
+  resetBuildStats();
+
+  if (keepMemory()) /* 配列サイズが確定したのでメモリ確保 */
+    return I_FAILED_MEMORY;
+
+  try {
+    memcpy(i_base_,  i_base,  sizeof(i_base_[0])  * i_array_size_);
+    memcpy(i_check_, i_check, sizeof(i_check_[0]) * i_array_size_);
+    memcpy(c_tail_,  c_tail,  sizeof(c_tail_[0])  * i_tail_size_);
+    if (i_result) {
+      memcpy(i_result_, i_result, sizeof(i_result_[0]) * i_result_size_);
+    } else {
+      i_result_ = nullptr;
+    }
+  } catch (...) {
+    deleteMemory();
+    return I_FAILED_MEMORY;
+  }
+
+  return I_NO_ERROR;
+}
+
+
+/* データを追加する 既に存在する場合は結果を更新する */
+/* @param c_byte        追加するByte列               */
+/* @param i_byte_length 追加するByte長               */
+/* @param result        検索結果                     */
+/* @return Error Code                                */
+int DoubleArray::insert(
+  const char* c_byte,
+  const uint64_t i_byte_length,
+  const int64_t result) noexcept
+{
+  if (p_mapped_ || units_ || result_blocks_ || (i_option_ & (I_SHARE_TAIL | I_CODE_TABLE)))
+    return I_NOT_SUPPORTED;
+
+  deleteReverseIndex(); /* Leafの位置が変わるので作り直しが必要 */
+  deleteScanTable();
+  if (!checkInit()) { /* 空の場合はRootだけ作る */
+    i_option_ = I_NO_OPTION;
+    if (keepMemory(true)) {
+      return I_FAILED_MEMORY;
+    }
+    if (baseCheckExtendMemory(0x100 + 1)) { /* Base値+0xffまでは配列内に収める */
+      return I_FAILED_MEMORY;
+    }
+    i_base_[0]   = 1;
+    i_tail_used_ = 1; /* TailIndexは1から */
+  }
+  if (i_tail_used_ == 0) {
+    i_tail_used_ = i_tail_size_;
+  }
+
+  /* 終端記号の分も含めて辿る */
+  auto byteAt = [c_byte, i_byte_length](const uint64_t i) {
+    return static_cast<unsigned char>(i < i_byte_length ? c_byte[i] : C_TAIL_CHAR);
+  };
+
+  int i_base_index(0);
+  for (uint64_t i = 0; i <= i_byte_length; ++i) {
+    int i_check_index(i_base_[i_base_index] + byteAt(i));
+    if (i_check_[i_check_index] != i_base_index) { /* 分岐を追加して残りはTailへ */
+      int i_tail_index;
+      if (addChild(i_base_index, byteAt(i), i_check_index)
+      ||  appendTail(i_tail_index, c_byte + i + 1, (i < i_byte_length ? i_byte_length - i - 1 : 0), result)) {
+        return I_FAILED_MEMORY;
+      }
+      i_base_[i_check_index] = (-i_tail_index);  /* TailIndexはマイナス値 */
+      return I_NO_ERROR;
+    }
+
+    if (i_base_[i_check_index] >= 0) {
+      i_base_index = i_check_index;
+      continue;
+    }
+
+    /* Tailと比較 */
+    const int i_tail_index(-i_base_[i_check_index]);
+    const uint64_t i_rest_length(i < i_byte_length ? i_byte_length - i - 1 : 0);
+    const char* c_rest(c_byte + i + 1);
+    uint64_t i_same(0);
+    while ((i_same < i_rest_length) && (c_tail_[i_tail_index + i_same] == c_rest[i_same])) {
+      ++i_same;
+    }
+    if ((i_same == i_rest_length) && (c_tail_[i_tail_index + i_same] == C_TAIL_CHAR)) {
+      if (i_result_) i_result_[i_tail_index + i_same] = result;  /* 既に存在するので更新 */
+      return I_NO_ERROR;
+    }
+
+    /* 一致した部分をNodeにして、分岐先に既存のTailの残りと追加データの残りを置く */
+    const unsigned char c_old_label(c_tail_[i_tail_index + i_same]);
+    const unsigned char c_new_label(i_same < i_rest_length ? c_rest[i_same] : C_TAIL_CHAR);
+    const int i_old_tail(i_tail_index + i_same + (c_old_label == C_TAIL_CHAR ? 0 : 1));
+    int i_new_tail;
+    if (appendTail(i_new_tail, c_rest + i_same + 1, (i_same < i_rest_length ? i_rest_length - i_same - 1 : 0), result)) {
+      return I_FAILED_MEMORY;
+    }
+    memset(&c_tail_[i_tail_index], C_TAIL_CHAR, i_old_tail - i_tail_index); /* 復元時にTail先頭を見つけられるようにする */
+
+    i_base_index = i_check_index;
+    for (uint64_t j = 0; j < i_same; ++j) {
+      const unsigned char c_label(c_rest[j]);
+      unsigned int i_base_value;
+      if (findFreeBase(i_base_value, &c_label, 1)) {
+        return I_FAILED_MEMORY;
+      }
+      i_base_[i_base_index]            = i_base_value;
+      i_check_[i_base_value + c_label] = i_base_index;
+      i_base_index                     = i_base_value + c_label;
+    }
+
+    const unsigned char c_labels[2] = { min(c_old_label, c_new_label), max(c_old_label, c_new_label) };
+    unsigned int i_base_value;
+    if (findFreeBase(i_base_value, c_labels, 2)) {
+      return I_FAILED_MEMORY;
+    }
+    i_base_[i_base_index]                = i_base_value;
+    i_check_[i_base_value + c_old_label] = i_base_index;
+    i_base_[i_base_value + c_old_label]  = (-i_old_tail);  /* TailIndexはマイナス値 */
+    i_check_[i_base_value + c_new_label] = i_base_index;
+    i_base_[i_base_value + c_new_label]  = (-i_new_tail);
+    return I_NO_ERROR;
+  }
+
+  return I_FAILED_TRIE; /* 終端記号の先にNodeがある 途中にNULLを含むデータと衝突 */
+}
+
+
+/* データを削除する                      */
+/* @param c_byte        削除するByte列   */
+/* @param i_byte_length 削除するByte長   */
+/* @return true : 削除した  false : 無し */
+bool DoubleArray::erase(
+  const char* c_byte,
+  const uint64_t i_byte_length) noexcept
+{
+  if (p_mapped_ || units_ || result_blocks_ || (i_option_ & (I_SHARE_TAIL | I_CODE_TABLE)) || !checkInit())
+    return false;
+
+  deleteReverseIndex();
+  deleteScanTable();
+  vector<int> i_path;
+  try {
+    i_path.reserve(64);
+  } catch (...) {
+    return false;
+  }
+
+  int i_base_index(0), i_check_index(0);
+  for (uint64_t i = 0; i <= i_byte_length; ++i) {
+    const unsigned char c_label(i < i_byte_length ? c_byte[i] : C_TAIL_CHAR);
+    i_check_index = i_base_[i_base_index] + c_label;
+    if (i_check_[i_check_index] != i_base_index)
+      return false;
+
+    if (i_base_[i_check_index] < 0) {
+      /* Tailと比較 */
+      const int i_tail_index(-i_base_[i_check_index]);
+      const uint64_t i_rest_length(i < i_byte_length ? i_byte_length - i - 1 : 0);
+      if ((memcmp(&c_tail_[i_tail_index], c_byte + i + 1, i_rest_length) != 0)
+      ||  (c_tail_[i_tail_index + i_rest_length] != C_TAIL_CHAR))
+        return false;
+
+      if (i_result_) i_result_[i_tail_index + i_rest_length] = I_SEARCH_NOHIT;  /* 復元対象から外す */
+      break;
+    }
+
+    try {
+      i_path.push_back(i_base_index);
+    } catch (...) {
+      return false;
+    }
+    i_base_index = i_check_index;
+  }
+  if (i_base_[i_check_index] >= 0)
+    return false;
+
+  /* Leafを削除し、子が無くなったNodeを遡って削除 */
+  unsigned char c_labels[256];
+  while (true) {
+    i_base_[i_check_index]  = 0;
+    i_check_[i_check_index] = I_ARRAY_NO_DATA;
+    i_free_index_ = min<uint64_t>(i_free_index_, i_check_index);
+    if ((i_base_index == 0) || (getChildLabels(c_labels, i_base_index) > 0))
+      break;
+
+    i_check_index = i_base_index;
+    i_base_index  = i_path.back();
+    i_path.pop_back();
+  }
+
+  return true;
+}
+
+
+/* Nodeに子を追加する 衝突した場合は再配置する */
+/* @param i_base_index 親のBaseCheckIndex      */
+/* @param c_label      追加するByte            */
+/* @param i_insert     追加した子の位置        */
+/* @return Error Code                          */
+int DoubleArray::addChild(
+  int& i_base_index,
+  const unsigned char c_label,
+  int& i_insert) noexcept
+{
+  i_insert = i_base_[i_base_index] + c_label;
+  if (i_check_[i_insert] != I_ARRAY_NO_DATA) {
+    /* 衝突 子の少ない方を再配置する */
+    unsigned char c_labels[257], c_other_labels[256];
+    int i_label_count(getChildLabels(c_labels, i_base_index));
+    const int i_other_index(i_check_[i_insert]);
+    const int i_other_count(getChildLabels(c_other_labels, i_other_index));
+
+    unsigned int i_base_value;
+    if (i_label_count + 1 <= i_other_count) {
+      c_labels[i_label_count++] = c_label;
+      sort(c_labels, c_labels + i_label_count);
+      if (findFreeBase(i_base_value, c_labels, i_label_count)) {
+        return I_FAILED_MEMORY;
+      }
+      relocateNode(i_base_index, i_base_value, c_labels, i_label_count);
+    } else {
+      if (findFreeBase(i_base_value, c_other_labels, i_other_count)) {
+        return I_FAILED_MEMORY;
+      }
+      const bool b_moved(i_check_[i_base_index] == i_other_index);  /* 親自身も移動する */
+      const int i_label(i_base_index - i_base_[i_other_index]);
+      relocateNode(i_other_index, i_base_value, c_other_labels, i_other_count);
+      if (b_moved) {
+        i_base_index = i_base_value + i_label;
+      }
+    }
+    i_insert = i_base_[i_base_index] + c_label;
+  }
+
+  i_check_[i_insert] = i_base_index;
+  if ((i_free_end_ != 0) && (i_free_end_ <= static_cast<uint64_t>(i_insert))) {
+    i_free_end_ = i_insert + 1;
+  }
+  return I_NO_ERROR;
+}
+
+
+/* 子を全て置けるBase値を空き要素から探す */
+/* @param i_base_value  求めたBase値      */
+/* @param c_labels      子のByte 昇順     */
+/* @param i_label_count 子の数            */
+/* @return Error Code                     */
+int DoubleArray::findFreeBase(
+  unsigned int& i_base_value,
+  const unsigned char* c_labels,
+  const int i_label_count) noexcept
+{
+  const uint64_t i_first_label(c_labels[0]);
+  const uint64_t i_last_label(c_labels[i_label_count - 1]);
+  if (i_free_end_ == 0) { /* 使用済みの末尾を求める */
+    i_free_end_ = 1;
+    for (uint64_t i = i_array_size_; i > 0; --i) {
+      if ((i_check_[i - 1] != I_ARRAY_NO_DATA) || i_base_[i - 1]) {
+        i_free_end_ = i;
+        break;
+      }
+    }
+  }
+
+  /* 途中の要素を一定数だけ試し、置けなければ使用済みの末尾の後ろに置く */
+  bool b_found(false);
+  uint64_t i_empty(i_free_index_);
+  for (int i_trial = 0; (i_trial < I_FREE_SEARCH_LIMIT) && (i_empty < i_free_end_); ++i_trial, ++i_empty) {
+    if (i_check_[i_empty] != I_ARRAY_NO_DATA) {
+      if (i_empty == i_free_index_) ++i_free_index_;  /* 埋まっている先頭は次回から探さない */
+      continue;
+    }
+    if ((i_empty <= i_first_label) || (i_array_size_ <= i_empty - i_first_label + 0xff))
+      continue;
+
+    i_base_value = static_cast<unsigned int>(i_empty - i_first_label);
+    int i(1);
+    while ((i < i_label_count) && (i_check_[i_base_value + c_labels[i]] == I_ARRAY_NO_DATA)) {
+      ++i;
+    }
+    if (i == i_label_count) {
+      b_found = true;
+      break;
+    }
+  }
+  if (!b_found) {
+    i_free_index_ = i_empty;  /* 試した範囲の空きは以降使わない */
+    i_base_value  = static_cast<unsigned int>(max(i_free_end_, i_first_label + 1) - i_first_label);
+  }
+
+  if ((i_array_size_ <= i_base_value + 0xff)
+  &&  (baseCheckExtendMemory(i_base_value + 0x100))) { /* Base値+0xffまでは配列内に収める */
+    return I_FAILED_MEMORY;
+  }
+  i_free_end_ = max<uint64_t>(i_free_end_, i_base_value + i_last_label + 1);
+
+  return I_NO_ERROR;
+}
+
+
+/* Nodeの子を別のBase値の位置に移す    */
+/* @param i_base_index  移すNode       */
+/* @param i_base_value  移動先のBase値 */
+/* @param c_labels      子のByte       */
+/* @param i_label_count 子の数         */
+void DoubleArray::relocateNode(
+  const int i_base_index,
+  const unsigned int i_base_value,
+  const unsigned char* c_labels,
+  const int i_label_count) noexcept
+{
+  const int i_old_base(i_base_[i_base_index]);
+  for (int i = 0; i < i_label_count; ++i) {
+    const int i_old(i_old_base + c_labels[i]);
+    const int i_new(i_base_value + c_labels[i]);
+    if (i_check_[i_old] != i_base_index)
+      continue;  /* 追加予定の子 */
+
+    i_base_[i_new]  = i_base_[i_old];
+    i_check_[i_new] = i_base_index;
+    if (i_base_[i_old] > 0) { /* 孫の親を付け替え */
+      for (int c = 0; c < 256; ++c) {
+        if (i_check_[i_base_[i_old] + c] == i_old) {
+          i_check_[i_base_[i_old] + c] = i_new;
+        }
+      }
+    }
+    i_base_[i_old]  = 0;
+    i_check_[i_old] = I_ARRAY_NO_DATA;
+    i_free_index_ = min<uint64_t>(i_free_index_, i_old);
+  }
+  i_base_[i_base_index] = i_base_value;
+}
+
+
+/* Nodeの子のByteを取得する          */
+/* @param c_labels     子のByte 昇順 */
+/* @param i_base_index Node          */
+/* @return 子の数                    */
+int DoubleArray::getChildLabels(
+  unsigned char* c_labels,
+  const int i_base_index) const noexcept
+{
+  int i_label_count(0);
+  const int i_base_value(i_base_[i_base_index]);
+  if (i_base_value <= 0)
+    return 0;
+
+  for (int c = 0; c < 256; ++c) {
+    if (i_check_[i_base_value + c] == i_base_index) {
+      c_labels[i_label_count++] = static_cast<unsigned char>(c);
+    }
+  }
+
+  return i_label_count;
+}
+
+
+/* Tail末尾にByte列と終端記号を追加する   */
+/* @param i_tail_index  追加した開始Index */
+/* @param c_byte        追加するByte列    */
+/* @param i_byte_length 追加するByte長    */
+/* @param result        検索結果          */
+/* @return Error Code                     */
+int DoubleArray::appendTail(
+  int& i_tail_index,
+  const char* c_byte,
+  const uint64_t i_byte_length,
+  const int64_t result) noexcept
+{
+  if ((i_tail_size_ <= i_tail_used_ + i_byte_length)
+  &&  (tailExtendMemory(i_tail_used_ + i_byte_length + 1))) {
+    return I_FAILED_MEMORY;
+  }
+
+  i_tail_index = static_cast<int>(i_tail_used_);
+  memcpy(&c_tail_[i_tail_used_], c_byte, i_byte_length);
+  i_tail_used_ += i_byte_length;
+  c_tail_[i_tail_used_] = C_TAIL_CHAR;
+  if (i_result_) i_result_[i_tail_used_] = result;
+  ++i_tail_used_;
+
+  return I_NO_ERROR;
+}
+
+
+/* 結果からLeafを引く逆引きIndexを作成する                 */
+/* @return I_NO_ERROR : 正常終了  I_NOT_SUPPORTED : 未対応 */
+int DoubleArray::createReverseIndex() noexcept
+{
+  if (p_mapped_ || !checkInit() || ((i_result_ == nullptr) && (result_blocks_ == nullptr)))
+    return I_NOT_SUPPORTED;
+
+  deleteReverseIndex();
+  uint64_t i_leaf_count(0);
+  for (uint64_t i = 1; i < i_array_size_; ++i) {
+    if ((getCheck(i) != I_ARRAY_NO_DATA) && (getBase(i) < 0)) {
+      ++i_leaf_count;
+    }
+  }
+
+  try {
+    reverse_index_ = new DAReverseEntry[i_leaf_count];
+  } catch (...) {
+    return I_FAILED_MEMORY;
+  }
+  i_reverse_size_ = i_leaf_count;
+
+  uint64_t i_entry(0);
+  for (uint64_t i = 1; i < i_array_size_; ++i) {
+    if ((getCheck(i) == I_ARRAY_NO_DATA) || (getBase(i) >= 0))
+      continue;
+
+    int i_tail_index(-getBase(i));
+    while (c_tail_[i_tail_index] != C_TAIL_CHAR) {
+      ++i_tail_index;
+    }
+    reverse_index_[i_entry].i_result_     = getTailResult(i_tail_index);
+    reverse_index_[i_entry].i_leaf_index_ = static_cast<int>(i);
+    reverse_index_[i_entry].i_tail_index_ = i_tail_index;
+    ++i_entry;
+  }
+
+  sort(reverse_index_, reverse_index_ + i_reverse_size_, [](const DAReverseEntry& left, const DAReverseEntry& right) {
+    return ((left.i_result_ != right.i_result_) ? (left.i_result_ < right.i_result_) : (left.i_tail_index_ < right.i_tail_index_));
+  });
+
+  return I_NO_ERROR;
+}
+
+
+/* 逆引きIndexを破棄する */
+void DoubleArray::deleteReverseIndex() noexcept
+{
+  if ((reverse_index_) && (p_mapped_ == nullptr)) {
+    delete[] reverse_index_;
+  }
+  reverse_index_  = nullptr;
+  i_reverse_size_ = 0;
+}
+
+
+/* 逆引きIndexから結果に対応するLeafを探す          */
+/* 同じ結果が複数ある場合はTail終端位置が最大のもの */
+/* @param i_result_index 探す結果Index              */
+/* @return LeafのBaseCheckIndex 0 : 該当無し        */
+uint64_t DoubleArray::findReverseLeaf(
+  const int64_t i_result_index) const noexcept
+{
+  const DAReverseEntry* entry_begin(reverse_index_);
+  const DAReverseEntry* entry = upper_bound(entry_begin, entry_begin + i_reverse_size_, i_result_index, [](const int64_t i_result, const DAReverseEntry& right) {
+    return i_result < right.i_result_;
+  });
+  if ((entry == entry_begin) || ((--entry)->i_result_ != i_result_index))
+    return 0;
+
+  return static_cast<uint64_t>(entry->i_leaf_index_);
+}
+
+
+/* scanの状態から1Byte遷移する                                                   */
+/* @param i_state 状態 i_array_size_未満はNode、それ以上はTail位置+i_array_size_ */
+/* @param c_label 遷移するByte                                                   */
+/* @return 遷移先の状態 -1 : 遷移できない                                        */
+inline int DoubleArray::getScanNext(
+  const int i_state,
+  const unsigned char c_label) const noexcept
+{
+  if (static_cast<uint64_t>(i_state) >= i_array_size_) {
+    const char c_tail(c_tail_[i_state - i_array_size_]);
+    return (((c_tail != C_TAIL_CHAR) && (c_tail == static_cast<char>(c_label))) ? i_state + 1 : -1);
+  }
+
+  const int i_next(getBase(i_state) + c_code_table_[c_label]);
+  if ((c_label == C_TAIL_CHAR) || (getCheck(i_next) != i_state))
+    return -1;
+
+  const int i_base(getBase(i_next));
+  return (i_base >= 0 ? i_next : static_cast<int>(i_array_size_) - i_base);  /* LeafはTail先頭の状態にする */
+}
+
+
+/* scanの状態で終わるデータがあれば結果を取得する */
+/* @param result  search result                   */
+/* @param i_state 状態                            */
+/* @return true : データの終端                    */
+bool DoubleArray::getScanResult(
+  int64_t& result,
+  const int i_state) const noexcept
+{
+  if (i_state == 0)
+    return false; /* 長さ0のデータは通知しない */
+
+  if (static_cast<uint64_t>(i_state) >= i_array_size_) {
+    const uint64_t i_tail_index(i_state - i_array_size_);
+    if (c_tail_[i_tail_index] != C_TAIL_CHAR)
+      return false;
+
+    result = getTailResult(i_tail_index);
+    return true;
+  }
+
+  const int i_terminal(getBase(i_state) + C_TAIL_CHAR);
+  if ((getCheck(i_terminal) != i_state) || (getBase(i_terminal) >= 0))
+    return false;
+
+  result = getTailResult(-getBase(i_terminal));
+  return true;
+}
+
+
+/* scan用の失敗遷移, 出力遷移の表を作成する                */
+/* @return I_NO_ERROR : 正常終了  I_NOT_SUPPORTED : 未対応 */
+int DoubleArray::createScanTable() noexcept
+{
+  if (!checkInit() || (i_option_ & I_SHARE_TAIL)) /* 共有したTail位置は状態を特定できない */
+    return I_NOT_SUPPORTED;
+
+  const uint64_t i_state_count(i_array_size_ + i_tail_size_);
+  if (i_state_count > static_cast<uint64_t>(numeric_limits<int>::max()))
+    return I_NOT_SUPPORTED;
+
+  deleteScanTable();
+  vector<int> i_queue;  /* 幅優先で辿る状態 */
+  try {
+    scan_states_ = new DAScanState[i_state_count];
+    i_queue.reserve(1024);
+  } catch (...) {
+    deleteScanTable();
+    return I_FAILED_MEMORY;
+  }
+  memset(scan_states_, 0, sizeof(scan_states_[0]) * i_state_count);
+
+  int64_t result;
+  auto setChild = [&](const int i_state, const int i_child, const unsigned char c_label) {
+    auto& child = scan_states_[i_child];
+    child.i_depth_ = scan_states_[i_state].i_depth_ + 1;
+    if (i_state != 0) {
+      int i_failure(scan_states_[i_state].i_failure_), i_next;
+      while (((i_next = getScanNext(i_failure, c_label)) < 0) && (i_failure != 0)) {
+        i_failure = scan_states_[i_failure].i_failure_;
+      }
+      child.i_failure_ = (i_next < 0 ? 0 : i_next);
+    }
+    child.i_output_ = (getScanResult(result, child.i_failure_) ? child.i_failure_ : scan_states_[child.i_failure_].i_output_);
+    i_queue.push_back(i_child);
+  };
+
+  try {
+    i_queue.push_back(0);
+    for (uint64_t i = 0; i < i_queue.size(); ++i) {
+      const int i_state(i_queue[i]);
+      if (static_cast<uint64_t>(i_state) >= i_array_size_) {  /* Tailは次のByteだけ */
+        const char c_label(c_tail_[i_state - i_array_size_]);
+        if (c_label != C_TAIL_CHAR) {
+          setChild(i_state, i_state + 1, static_cast<unsigned char>(c_label));
+        }
+        continue;
+      }
+
+      for (int i_label = 1; i_label <= 0xff; ++i_label) {  /* 終端記号への遷移は状態にしない */
+        const int i_next(getScanNext(i_state, static_cast<unsigned char>(i_label)));
+        if (i_next >= 0) {
+          setChild(i_state, i_next, static_cast<unsigned char>(i_label));
+        }
+      }
+    }
+  } catch (...) {
+    deleteScanTable();
+    return I_FAILED_MEMORY;
+  }
+
+  return I_NO_ERROR;
+}
+
+
+/* scan用の表を破棄する */
+void DoubleArray::deleteScanTable() noexcept
+{
+  if (scan_states_) {
+    delete[] scan_states_;
+  }
+  scan_states_ = nullptr;
+}
+
+
+/* テキスト中に現れる全てのデータを1回の走査で探す */
+/* @param c_text        走査するテキスト           */
+/* @param i_text_length テキストのバイト長         */
+/* @param found         一致毎に呼び出す関数       */
+/* @return 通知した一致数                          */
+uint64_t DoubleArray::scan(
+  const char* c_text,
+  const uint64_t i_text_length,
+  const ScanFunction& found) const noexcept
+{
+  if (scan_states_ == nullptr)
+    return 0;
+
+  uint64_t i_count(0);
+  int i_state(0);
+  int64_t result;
+  for (uint64_t i = 0; i < i_text_length; ++i) {
+    const unsigned char c_label(static_cast<unsigned char>(c_text[i]));
+    int i_next;
+    while (((i_next = getScanNext(i_state, c_label)) < 0) && (i_state != 0)) {
+      i_state = scan_states_[i_state].i_failure_;
+    }
+    i_state = (i_next < 0 ? 0 : i_next);
+
+    for (int i_output = i_state; i_output != 0; i_output = scan_states_[i_output].i_output_) {
+      if (!getScanResult(result, i_output))
+        continue; /* 失敗遷移側の出力のみ */
+
+      const uint64_t i_length(scan_states_[i_output].i_depth_);
+      ++i_count;
+      if (!found(i + 1 - i_length, i_length, result))
+        return i_count;
+    }
+  }
+
+  return i_count;
+}
+
+
+/* 結果IndexからByte情報を復元する                                 */
+/* 逆引きIndexがあれば二分探索、無ければ全要素を走査してLeafを探す */
+/* @param c_info         復元したByte情報 呼び出し側でdeleteする   */
+/* @param i_reuslt_index 復元する結果Index                         */
+void DoubleArray::reproductionFromIndex(
+  char*& c_info,
+  const int64_t i_result_index) const noexcept
+{
+  c_info = nullptr;
+  uint64_t i_array_index(0); /* Leaf位置特定 */
+  if (reverse_index_) {
+    i_array_index = findReverseLeaf(i_result_index);
+  } else if (result_blocks_) {  /* 結果を持つLeafを全て確認する */
+    uint64_t i_last(0);
+    for (uint64_t i = 1; i < i_array_size_; ++i) {
+      if ((getCheck(i) == I_ARRAY_NO_DATA) || (getBase(i) >= 0))
+        continue;
+
+      uint64_t i_tail_index(-getBase(i));
+      while (c_tail_[i_tail_index] != C_TAIL_CHAR) {
+        ++i_tail_index;
+      }
+      if ((i_tail_index > i_last) && (getCompactResult(i_tail_index) == i_result_index)) {
+        i_last        = i_tail_index;
+        i_array_index = i;
+      }
+    }
+  } else {
+    uint64_t i_last(0);
+    for (uint64_t i = 0; i < i_result_size_; ++i) {
+      if (i_result_[i] == i_result_index) {
+        i_last = i;
+      }
+    }
+
+    if (i_last == 0) {
+      return; /* 指定のIndexは無し */
+    }
+
+    int64_t i_tail_index(--i_last);  /* 終端記号を指しているので一つ前にする */
+    while (c_tail_[i_tail_index]) {
+      --i_tail_index;
+    }
+    ++i_tail_index; /* Tail先頭の位置にするのでIncrement */
+
+    for (uint64_t i = 0; i < i_array_size_; ++i) {
+      if ((getBase(i) < 0)
+      &&  ((-getBase(i)) == i_tail_index)) {
+        i_array_index = i;
+        break;
+      }
+    }
+  }
+
+  if (i_array_index == 0) {
+    return; /* 指定のIndexは無し */
+  }
+
+  vector<char> datas; /* 親へ遡るので逆順に格納 */
+  const char* c_tail(c_tail_ - getBase(i_array_index));
+  while (i_array_index != 0) {
+    uint64_t i_char = c_code_bytes_[(i_array_index - getBase(getCheck(i_array_index))) & 0xff];
+    datas.push_back(static_cast<char>(i_char));
+    i_array_index = getCheck(i_array_index);
+  }
+
+  int i_index(0);
+  const uint64_t i_tail_length(strlen(c_tail));
+  c_info = new char[datas.size() + i_tail_length + 1];
+  for (auto data = datas.crbegin(), data_end = datas.crend(); data != data_end; ++data) {
+    c_info[i_index++] = *data;
+  }
+  memcpy(c_info + i_index, c_tail, i_tail_length);
+  c_info[i_index + i_tail_length] = 0x00; /* 終端記号 */
+}
+
+
+/* 配置の統計と直近の構築の記録を求める */
+/* @param stats 統計情報                */
+/* @return Error Code                   */
+int DoubleArray::getStats(
+  DAStats& stats) const noexcept
+{
+  stats = DAStats();
+  stats.i_base_check_extends_ = i_base_check_extends_;
+  stats.i_tail_extends_       = i_tail_extends_;
+  memcpy(stats.i_build_times_, i_build_times_, sizeof(stats.i_build_times_));
+  if (!checkInit())
+    return I_NO_ERROR;
+
+  stats.i_array_size_  = i_array_size_;
+  stats.i_tail_size_   = (i_tail_used_ ? i_tail_used_ : i_tail_size_);
+  stats.i_result_size_ = (i_result_ ? i_result_size_ : 0);
+
+  /* 深さは親(Check)を辿って求め、求めた分は覚えておく 0 : 未計算 */
+  vector<uint32_t> i_depths;
+  vector<uint64_t> i_path;
+  try {
+    i_depths.assign(i_array_size_, 0);
+    for (uint64_t i = 1; i < i_array_size_; ++i) {
+      const int i_check(getCheck(static_cast<int>(i)));
+      if (i_check == I_ARRAY_NO_DATA)
+        continue;
+
+      ++stats.i_used_slots_;
+      for (uint64_t j = i; (j != 0) && (i_depths[j] == 0); j = getCheck(static_cast<int>(j))) {
+        i_path.push_back(j);
+      }
+      for (uint64_t i_depth = (i_path.empty() ? 0 : i_depths[getCheck(static_cast<int>(i_path.back()))]); !i_path.empty(); i_path.pop_back()) {
+        i_depths[i_path.back()] = static_cast<uint32_t>(++i_depth);
+      }
+
+      const int i_base_value(getBase(static_cast<int>(i)));
+      if (i_base_value >= 0)
+        continue;
+
+      /* Leaf */
+      ++stats.i_leaf_count_;
+      if (stats.i_depth_counts_.size() <= i_depths[i]) {
+        stats.i_depth_counts_.resize(i_depths[i] + 1, 0);
+      }
+      ++stats.i_depth_counts_[i_depths[i]];
+      stats.i_tail_bytes_ += strlen(&c_tail_[-i_base_value]) + 1;
+    }
+  } catch (...) {
+    return I_FAILED_MEMORY;
+  }
+
+  ++stats.i_used_slots_;  /* Root */
+  stats.i_unused_slots_ = i_array_size_ - stats.i_used_slots_;
+  stats.d_fill_ratio_   = static_cast<double>(stats.i_used_slots_) / static_cast<double>(i_array_size_);
+
+  /* Tailの先頭1byteは使わない */
+  if (stats.i_tail_bytes_ + 1 > stats.i_tail_size_) {
+    stats.i_shared_tail_bytes_ = stats.i_tail_bytes_ + 1 - stats.i_tail_size_;
+  }
+
+  if (stats.i_result_size_) {
+    stats.i_result_used_  = stats.i_leaf_count_;
+    stats.d_result_ratio_ = static_cast<double>(stats.i_result_used_) / static_cast<double>(stats.i_result_size_);
+  }
+
+  return I_NO_ERROR;
+}
+
+
+/* 検索Counterを取得する                                        */
+/* @param counters 検索Counter                                  */
+/* @return I_NO_ERROR : 正常終了  I_NOT_SUPPORTED : Counter無効 */
+int DoubleArray::getLookupCounters(
+  DALookupCounters& counters) noexcept
+{
+  counters = DALookupCounters();
+#ifdef DA_ENABLE_LOOKUP_COUNTERS
+  counters.i_searches_      = i_lookup_searches.load(memory_order_relaxed);
+  counters.i_transitions_   = i_lookup_transitions.load(memory_order_relaxed);
+  counters.i_tail_compares_ = i_lookup_tail_compares.load(memory_order_relaxed);
+  counters.i_misses_        = i_lookup_misses.load(memory_order_relaxed);
+  for (uint64_t i = 0; i < DALookupCounters::I_DEPTH_MAX; ++i) {
+    counters.i_miss_depths_[i] = i_lookup_miss_depths[i].load(memory_order_relaxed);
+  }
+
+  return I_NO_ERROR;
+#else
+  return I_NOT_SUPPORTED;
+#endif
+}
+
+
+/* 検索Counterを0に戻す */
+void DoubleArray::resetLookupCounters() noexcept
+{
+#ifdef DA_ENABLE_LOOKUP_COUNTERS
+  i_lookup_searches.store(0, memory_order_relaxed);
+  i_lookup_transitions.store(0, memory_order_relaxed);
+  i_lookup_tail_compares.store(0, memory_order_relaxed);
+  i_lookup_misses.store(0, memory_order_relaxed);
+  for (auto& i_miss_depth : i_lookup_miss_depths) {
+    i_miss_depth.store(0, memory_order_relaxed);
+  }
+#endif
+}
+
+
+/* 構築の記録を0に戻す */
+void DoubleArray::resetBuildStats() noexcept
+{
+  i_base_check_extends_ = 0;
+  i_tail_extends_       = 0;
+  memset(i_build_times_, 0, sizeof(i_build_times_));
+}
+
+
+/* 経過時間を求める        */
+/* @param start 開始時刻   */
+/* @return 経過時間 nano秒 */
+uint64_t DoubleArray::getElapsedTime(
+  const chrono::steady_clock::time_point& start) noexcept
+{
+  return static_cast<uint64_t>(chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count());
+}
+
+
+/* init only */
+DoubleArrayHandle::DoubleArrayHandle() noexcept
+  : current_(nullptr), i_epoch_(0), i_version_(0), b_loading_(false), i_load_error_(DoubleArray::I_NO_ERROR)
+{
+}
+
+
+/* 読み込みThreadの終了を待ち、現在のDoubleArrayを解放する */
+DoubleArrayHandle::~DoubleArrayHandle() noexcept
+{
+  waitLoad();
+  delete current_.exchange(nullptr);
+}
+
+
+/* 構築済みのDoubleArrayを公開する                        */
+/* @param double_array newで確保した構築済みのDoubleArray */
+/* @return I_NO_ERROR : 正常終了 0以外 : 異常終了         */
+int DoubleArrayHandle::publish(
+  DoubleArray* double_array) noexcept
+{
+  if (!double_array)
+    return DoubleArray::I_FAILED_TRIE;
+
+  lock_guard<mutex> lock(publish_mutex_);
+  DoubleArray* old_array(current_.exchange(double_array));
+  i_version_.fetch_add(1);
+  waitReaders();
+  delete old_array;
+
+  return DoubleArray::I_NO_ERROR;
+}
+
+
+/* writeBinaryで書き込んだファイルを新しいVersionとして読み込んで公開する */
+/* @param c_file_path   ファイルパス                                      */
+/* @param i_file_offset writeBinaryで書き込みを開始したファイル位置       */
+/* @param b_mapped      true : openMapped false : readBinary              */
+/* @return I_NO_ERROR : 正常終了 0以外 : 異常終了                         */
+int DoubleArrayHandle::load(
+  const char* c_file_path,
+  const uint64_t i_file_offset,
+  const bool b_mapped) noexcept
+{
+  DoubleArray* double_array(new (nothrow) DoubleArray());
+  if (!double_array)
+    return DoubleArray::I_FAILED_MEMORY;
+
+  int i_error(DoubleArray::I_NO_ERROR);
+  if (b_mapped) {
+    i_error = double_array->openMapped(c_file_path, i_file_offset);
+  } else {
+    FILE* fp(fopen(c_file_path, "rb"));
+    if (!fp) {
+      i_error = DoubleArray::I_FAIELD_FILE_IO;
+    } else {
+      int64_t i_read_size(0);
+      if (fseeko(fp, static_cast<off_t>(i_file_offset), SEEK_SET) != 0)
+        i_error = DoubleArray::I_FAIELD_FILE_IO;
+      else
+        i_error = double_array->readBinary(i_read_size, fp);
+      fclose(fp);
+    }
+  }
+
+  if (i_error) {
+    delete double_array;
+    return i_error;
+  }
+
+  return publish(double_array);
+}
+
+
+/* 別Threadでloadを行う                                                         */
+/* @param c_file_path   ファイルパス                                            */
+/* @param i_file_offset writeBinaryで書き込みを開始したファイル位置             */
+/* @param b_mapped      true : openMapped false : readBinary                    */
+/* @return true : 読み込み開始  false : 読み込み中 もしくはThreadを起動できない */
+bool DoubleArrayHandle::loadAsync(
+  const char* c_file_path,
+  const uint64_t i_file_offset,
+  const bool b_mapped) noexcept
+{
+  bool b_loading(false);
+  if (!b_loading_.compare_exchange_strong(b_loading, true))
+    return false;
+
+  if (load_thread_.joinable())
+    load_thread_.join();  /* 前回のThreadは終了済み */
+
+  try {
+    load_thread_ = thread([this, file_path = string(c_file_path), i_file_offset, b_mapped] () {
+      i_load_error_.store(load(file_path.c_str(), i_file_offset, b_mapped));
+      b_loading_.store(false);});
+  } catch (...) {
+    i_load_error_.store(DoubleArray::I_FAILED_MEMORY);
+    b_loading_.store(false);
+    return false;
+  }
+
+  return true;
+}
+
+
+/* loadAsyncの終了を待つ               */
+/* @return 最後に行ったloadAsyncの結果 */
+int DoubleArrayHandle::waitLoad() noexcept
+{
+  if (load_thread_.joinable())
+    load_thread_.join();
+
+  return i_load_error_.load();
+}
+
+
+/* 公開中のVersion番号を取得する */
+/* @return publishした回数       */
+uint64_t DoubleArrayHandle::getVersion() const noexcept
+{
+  return i_version_.load();
+}
+
+
+/* 差し替え前に参照を始めたReaderが全て抜けるまで待つ              */
+/* Epochを2回進めて、偶奇それぞれのカウンタが0になるのを待つ。     */
+/* 1回目で新規Readerを反対側に逃がし、2回目で古いEpochを読んだまま */
+/* 登録が遅れたReaderも確実に待つ                                  */
+void DoubleArrayHandle::waitReaders() noexcept
+{
+  for (int i_phase = 0; i_phase < 2; ++i_phase) {
+    const uint64_t i_parity(i_epoch_.fetch_add(1) & 1);
+    for (int i = 0; i < I_READER_SLOTS; ++i) {
+      while (slots_[i].i_count_[i_parity].load() != 0) {
+        this_thread::yield();
+      }
+    }
+  }
+}
+
+
+/* init only                                                    */
+/* @param i_option compactで作り直すDoubleArrayの構築オプション */
+DoubleArrayOverlay::DoubleArrayOverlay(
+  const int i_option) noexcept
+  : i_delta_size_(0), b_compacting_(false), i_compact_error_(DoubleArray::I_NO_ERROR), i_option_(i_option)
+{
+  for (auto& i_filter : i_delta_filter_) {
+    i_filter.store(0, memory_order_relaxed);
+  }
+}
+
+
+/* compactの終了を待つ */
+DoubleArrayOverlay::~DoubleArrayOverlay() noexcept
+{
+  waitCompact();
+}
+
+
+/* 土台のDoubleArrayを差し替える                          */
+/* @param double_array newで確保した構築済みのDoubleArray */
+/* @return I_NO_ERROR : 正常終了 0以外 : 異常終了         */
+int DoubleArrayOverlay::setBase(
+  DoubleArray* double_array) noexcept
+{
+  lock_guard<mutex> lock(compact_mutex_);
+  return base_.publish(double_array);
+}
+
+
+/* 検索する 差分→土台の順に調べる          */
+/* @param c_byte        search bytes       */
+/* @param i_byte_length search data length */
+/* @return search result                   */
+int64_t DoubleArrayOverlay::search(
+  const char* c_byte,
+  const uint64_t i_byte_length) const noexcept
+{
+  if (i_delta_size_.load(memory_order_acquire) != 0) {
+    const uint64_t i_bit(getFilterBit(c_byte, i_byte_length));
+    int64_t result(DoubleArray::I_SEARCH_NOHIT);
+    if ((i_delta_filter_[i_bit / 64].load(memory_order_acquire) & (1ULL << (i_bit % 64)))
+    &&  (searchDelta(result, c_byte, i_byte_length)))
+      return result;
+  }
+
+  DoubleArrayReader reader(base_);
+  return (reader ? reader->search(c_byte, i_byte_length) : DoubleArray::I_SEARCH_NOHIT);
+}
+
+
+/* データを追加する 既に存在する場合は結果を更新する */
+/* @param c_byte        追加するByte列               */
+/* @param i_byte_length 追加するByte長               */
+/* @param result        検索結果                     */
+/* @return Error Code                                */
+int DoubleArrayOverlay::insert(
+  const char* c_byte,
+  const uint64_t i_byte_length,
+  const int64_t result) noexcept
+{
+  if (i_byte_length == 0)
+    return DoubleArray::I_NOT_SUPPORTED;  /* 構築時と同じく空データは持てない */
+
+  return putDelta(c_byte, i_byte_length, DAOverlayEntry(result, false));
+}
+
+
+/* データを削除する                    */
+/* @param c_byte        削除するByte列 */
+/* @param i_byte_length 削除するByte長 */
+/* @return Error Code                  */
+int DoubleArrayOverlay::erase(
+  const char* c_byte,
+  const uint64_t i_byte_length) noexcept
+{
+  return putDelta(c_byte, i_byte_length, DAOverlayEntry(DoubleArray::I_SEARCH_NOHIT, true));
+}
+
+
+/* 差分を土台に併合したDoubleArrayを作って差し替える      */
+/* 差分を凍結してから併合し、差し替え後に凍結分を捨てる。 */
+/* 差し替えまでは凍結した差分も検索に使うので、           */
+/* どの時点でも検索結果は変わらない                       */
+/* @return Error Code                                     */
+int DoubleArrayOverlay::compact() noexcept
+{
+  lock_guard<mutex> lock(compact_mutex_);
+  try {
+    unique_lock<shared_mutex> delta_lock(delta_mutex_);
+    if (frozen_delta_.empty()) {
+      frozen_delta_.swap(active_delta_);
+    } else {  /* 前回の併合に失敗した分が残っている 新しい差分を優先する */
+      for (auto& delta : active_delta_) {
+        frozen_delta_[delta.first] = delta.second;
+      }
+      active_delta_.clear();
+    }
+  } catch (...) {
+    return DoubleArray::I_FAILED_MEMORY;
+  }
+  if (frozen_delta_.empty())
+    return DoubleArray::I_NO_ERROR;
+
+  /* frozen_delta_を変更するのはcompactだけなので、ロック無しで読める */
+  DoubleArray* merged(new (nothrow) DoubleArray());
+  if (!merged)
+    return DoubleArray::I_FAILED_MEMORY;
+
+  int i_error(DoubleArray::I_NO_ERROR);
+  {
+    DoubleArrayReader reader(base_);  /* 差し替えはcompact_mutex_で止めているので長く保持してよい */
+    i_error = mergeDelta(reader.get(), *merged);
+  }
+  if ((i_error) || ((i_error = base_.publish(merged)))) {
+    delete merged;
+    return i_error;
+  }
+
+  /* bit表を新しい差分の分だけにする 要素毎に旧bitの部分集合へ置き換えるので、 */
+  /* ロックを取らずに読むsearchが新しい差分を見落とすことはない                 */
+  vector<uint64_t> i_filters(I_FILTER_WORDS, 0);
+  unique_lock<shared_mutex> delta_lock(delta_mutex_);
+  frozen_delta_.clear();
+  for (const auto& delta : active_delta_) {
+    const uint64_t i_bit(getFilterBit(delta.first.data(), delta.first.size()));
+    i_filters[i_bit / 64] |= 1ULL << (i_bit % 64);
+  }
+  for (uint64_t i = 0; i < I_FILTER_WORDS; ++i) {
+    i_delta_filter_[i].store(i_filters[i], memory_order_release);
+  }
+  i_delta_size_.store(active_delta_.size(), memory_order_release);
+
+  return DoubleArray::I_NO_ERROR;
+}
+
+
+/* 別Threadでcompactを行う                                              */
+/* @return true : 併合開始  false : 併合中 もしくはThreadを起動できない */
+bool DoubleArrayOverlay::compactAsync() noexcept
+{
+  bool b_compacting(false);
+  if (!b_compacting_.compare_exchange_strong(b_compacting, true))
+    return false;
+
+  if (compact_thread_.joinable())
+    compact_thread_.join();  /* 前回のThreadは終了済み */
+
+  try {
+    compact_thread_ = thread([this] () {
+      i_compact_error_.store(compact());
+      b_compacting_.store(false);});
+  } catch (...) {
+    i_compact_error_.store(DoubleArray::I_FAILED_MEMORY);
+    b_compacting_.store(false);
+    return false;
+  }
+
+  return true;
+}
+
+
+/* compactAsyncの終了を待つ               */
+/* @return 最後に行ったcompactAsyncの結果 */
+int DoubleArrayOverlay::waitCompact() noexcept
+{
+  if (compact_thread_.joinable())
+    compact_thread_.join();
+
+  return i_compact_error_.load();
+}
+
+
+/* 差分の件数を取得する 凍結中の分も含む */
+/* @return 差分の件数                    */
+uint64_t DoubleArrayOverlay::getDeltaSize() const noexcept
+{
+  return i_delta_size_.load();
+}
+
+
+/* 差分から検索する 新しい差分→凍結した差分の順に調べる */
+/* @param result        search result                   */
+/* @param c_byte        search bytes                    */
+/* @param i_byte_length search data length              */
+/* @return true : 差分に記録がある                      */
+bool DoubleArrayOverlay::searchDelta(
+  int64_t& result,
+  const char* c_byte,
+  const uint64_t i_byte_length) const noexcept
+{
+  const string_view key(c_byte, i_byte_length);
+  shared_lock<shared_mutex> lock(delta_mutex_);
+  for (const DeltaMap* delta : { &active_delta_, &frozen_delta_ }) {
+    const auto it = delta->find(key);
+    if (it != delta->end()) {
+      result = (it->second.b_erased_ ? DoubleArray::I_SEARCH_NOHIT : it->second.i_result_);
+      return true;
+    }
+  }
+
+  return false;
+}
+
+
+/* 差分のbit表での位置を求める */
+/* @param c_byte        Byte列 */
+/* @param i_byte_length Byte長 */
+/* @return bit位置             */
+uint64_t DoubleArrayOverlay::getFilterBit(
+  const char* c_byte,
+  const uint64_t i_byte_length) noexcept
+{
+  return hash<string_view>()(string_view(c_byte, i_byte_length)) % (I_FILTER_WORDS * 64);
+}
+
+
+/* 差分を記録する                    */
+/* @param c_byte        Byte列       */
+/* @param i_byte_length Byte長       */
+/* @param entry         記録する差分 */
+/* @return Error Code                */
+int DoubleArrayOverlay::putDelta(
+  const char* c_byte,
+  const uint64_t i_byte_length,
+  const DAOverlayEntry& entry) noexcept
+{
+  try {
+    unique_lock<shared_mutex> lock(delta_mutex_);
+    active_delta_[string(c_byte, i_byte_length)] = entry;
+    const uint64_t i_bit(getFilterBit(c_byte, i_byte_length));
+    i_delta_filter_[i_bit / 64].fetch_or(1ULL << (i_bit % 64), memory_order_release);
+    i_delta_size_.store(active_delta_.size() + frozen_delta_.size(), memory_order_release);
+  } catch (...) {
+    return DoubleArray::I_FAILED_MEMORY;
+  }
+
+  return DoubleArray::I_NO_ERROR;
+}
+
+
+/* 土台と凍結した差分を辞書順に併合したDoubleArrayを作る */
+/* どちらも辞書順に並んでいるので、順に読みながら        */
+/* 整列済みデータからの構築に渡す                        */
+/* @param double_array 土台のDoubleArray nullptrは空     */
+/* @param merged       作成したDoubleArray               */
+/* @return Error Code                                    */
+int DoubleArrayOverlay::mergeDelta(
+  const DoubleArray* double_array,
+  DoubleArray& merged) const noexcept
+{
+  DAPredictiveParts predictive_parts;
+  int64_t base_result(DoubleArray::I_SEARCH_NOHIT);
+  bool b_base((double_array) && (double_array->checkInit())
+           && (double_array->predictiveSearch(predictive_parts, "", 0))
+           && (double_array->predictiveNext(predictive_parts, base_result)));
+  bool b_base_used(false);  /* 渡したc_key_は次の呼び出しまで有効にするので、土台を進めるのは次回 */
+  auto delta = frozen_delta_.begin();
+
+  /* 同じデータは差分を優先し、tombstoneは読み飛ばす */
+  auto readMerged = [&](const char*& c_byte, uint64_t& i_byte_length, int64_t& result) {
+    if (b_base_used) {
+      b_base = double_array->predictiveNext(predictive_parts, base_result);
+      b_base_used = false;
+    }
+    while ((b_base) || (delta != frozen_delta_.end())) {
+      int i_compare(1);  /* <0 : 土台が先 0 : 同じ >0 : 差分が先 */
+      if (delta == frozen_delta_.end()) {
+        i_compare = -1;
+      } else if (b_base) {
+        const auto& key = predictive_parts.c_key_;
+        i_compare = string_view(key.data(), key.size()).compare(delta->first);
+      }
+
+      if (i_compare < 0) {
+        c_byte        = predictive_parts.c_key_.data();
+        i_byte_length = predictive_parts.c_key_.size();
+        result        = base_result;
+        b_base_used   = true;
+        return true;
+      }
+
+      if (i_compare == 0) {
+        b_base = double_array->predictiveNext(predictive_parts, base_result);
+      }
+      const auto& entry = *delta++;
+      if (!entry.second.b_erased_) {
+        c_byte        = entry.first.data();
+        i_byte_length = entry.first.size();
+        result        = entry.second.i_result_;
+        return true;
+      }
+    }
+    return false;
+  };
+
+  if (!(i_option_ & DoubleArray::I_CODE_TABLE))
+    return merged.createDoubleArray(readMerged, i_option_);
+
+  /* Code表は出現頻度を全データから求めるので、一旦全て集める */
+  try {
+    ByteArrays datas;
+    const char* c_byte(nullptr);
+    uint64_t i_byte_length(0);
+    int64_t result(0);
+    while (readMerged(c_byte, i_byte_length, result)) {
+      datas.emplace_back(c_byte, i_byte_length, result);
+    }
+    return merged.createDoubleArray(datas, i_option_);
+  } catch (...) {
+    return DoubleArray::I_FAILED_MEMORY;
+  }
+}
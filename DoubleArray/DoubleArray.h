@@ -4,10 +4,10 @@
 /**
  * DoubleArray<br/>
  * 要素を1バイトとして処理している。<br/>
- * データ構造構築後、追加処理には対応していない。<br/>
+ * データ構造構築後もinsert/eraseで追加削除できる。<br/>
  * 検索結果のデータについては、呼び出し側で管理してもらい、<br/>
  * ダブル配列内ではメモリ管理はしない。<br/>
- * また、Codeの配列はない。文字列の1byteをそのまま使用している
+ * また、I_CODE_TABLE以外ではCodeの配列はない。文字列の1byteをそのまま使用している
  *
  * @briefダブル配列
  * @file DoubleArray.h
@@ -21,12 +21,47 @@
 #include <cstdint>
 #include <algorithm>
 #include <limits>
+#include <functional>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+#include <map>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <chrono>
 
 class NodeParts;
 class TrieNode;
+class DABuildArena;
+class DAStreamNode;
+class DAStreamChild;
+class DASubArray;
 class DASearchParts;
+class DACursorState;
+class DACursor;
+class DAFileHeader;
+class DAUnit;
+class DAReverseEntry;
+class DAResultBlock;
+class DAScanState;
+class DAEmptySlots;
+class DAPrefixResult;
+class DAToken;
+class DAStats;
+class DALookupCounters;
+class DAPredictiveParts;
 class ByteArray;
 class ByteArrays;
+class DAReaderSlot;
+class DoubleArrayHandle;
+class DoubleArrayReader;
+class DAOverlayEntry;
+class DoubleArrayOverlay;
+class DABasicFileHeader;
+template<class IndexT> class DABasicUnit;
+template<class IndexT, class ValueT> class BasicDoubleArray;
 
 /** DoubleArrayの構築&検索 */
 class DoubleArray
@@ -36,8 +71,16 @@ public:
   static constexpr int I_FAILED_TRIE      = 0x01; /* failed to create TRIE      */
   static constexpr int I_FAILED_MEMORY    = 0x02; /* Memory関連ERROR            */
   static constexpr int I_FAIELD_FILE_IO   = 0x04; /* FILE ERROR                 */
+  static constexpr int I_NOT_SUPPORTED    = 0x08; /* 現在の形式では未対応       */
   static constexpr int I_NO_OPTION        = 0x00; /* no option                  */
   static constexpr int I_TAIL_UNITY       = 0x01; /* 検索結果をtrue/falseに変換 */
+  static constexpr int I_UNIT_LAYOUT      = 0x02; /* Base/CheckをUnitにまとめる */
+  static constexpr int I_REVERSE_INDEX    = 0x04; /* 逆引きIndexを作成する      */
+  static constexpr int I_COMPACT_RESULT   = 0x08; /* 結果をKey毎に詰めて格納    */
+  static constexpr int I_SHARE_TAIL       = 0x10; /* 共通の末尾を持つTailを共有 */
+  static constexpr int I_KEY_ID           = 0x20; /* 結果を辞書順のKey IDにする */
+  static constexpr int I_SCAN_TABLE       = 0x40; /* scan用の遷移表を作成する   */
+  static constexpr int I_CODE_TABLE       = 0x80; /* 出現頻度順のCodeで遷移する */
   static constexpr int64_t I_HIT_DEFAULT  = 0x01; /* 検索結果統合時の返り値     */
   static constexpr int64_t I_SEARCH_NOHIT = 0x00; /* search no result           */
 
@@ -45,6 +88,35 @@ public:
   static constexpr int I_EXTEND_MEMORY      =   2;  /* 配列拡張倍率        */
   static constexpr int I_DEFAULT_ARRAY_SIZE = 256;  /* defaultの配列サイズ */
   static constexpr char C_TAIL_CHAR         = 0x00; /* TAILの末尾文字      */
+  static constexpr int I_BATCH_WIDTH        =  16;  /* 一括検索の同時進行数 */
+  static constexpr int I_FREE_SEARCH_LIMIT  = 1024; /* insert時に試す要素数 */
+
+  static constexpr uint64_t I_FILE_MAGIC   = 0x31595252414c4244; /* Binary形式の識別子 "DBLARRY1" */
+  static constexpr uint32_t I_FILE_VERSION = 1;                  /* Binary形式のVersion          */
+  static constexpr uint64_t I_PAGE_SIZE    = 4096;               /* Section配置のAlignment       */
+
+  static constexpr int I_PHASE_SORT     = 0; /* 構築データのSort        */
+  static constexpr int I_PHASE_OVERLAP  = 1; /* 重複Index情報の作成     */
+  static constexpr int I_PHASE_TRIE     = 2; /* Trieの構築              */
+  static constexpr int I_PHASE_LAYOUT   = 3; /* Base/Checkへの配置      */
+  static constexpr int I_PHASE_OPTIMIZE = 4; /* 最適化と各形式への変換  */
+  static constexpr int I_PHASE_COUNT    = 5; /* 構築段階の数            */
+
+  /** 整列済みデータを1件ずつ渡す関数
+  * c_byte, i_byte_length, resultに次のデータを設定してtrueを返す。データが無ければfalse
+  * c_byteの領域は次の呼び出しまで有効であればよい
+  */
+  typedef std::function<bool(const char*& c_byte, uint64_t& i_byte_length, int64_t& result)> ReadFunction;
+
+  /** scanで一致したデータを受け取る関数
+  * i_beginはテキスト中の開始位置、i_lengthは一致したバイト長。falseを返すとscanを打ち切る
+  */
+  typedef std::function<bool(uint64_t i_begin, uint64_t i_length, int64_t result)> ScanFunction;
+
+  /** fuzzySearchで見つかったデータを受け取る関数
+  * c_keyは次の呼び出しまで有効。i_distanceは検索Byte列との編集距離。falseを返すと検索を打ち切る
+  */
+  typedef std::function<bool(const char* c_key, uint64_t i_key_length, uint64_t i_distance, int64_t result)> FuzzyFunction;
 
 public:
   /** init only */
@@ -62,6 +134,41 @@ public:
     ByteArrays& add_datas,
     const int i_option = I_NO_OPTION) noexcept;
 
+  /** 複数Threadで並列にDoubleArrayを構築する
+  * 分割して並列にSortした後、全データ共通の接頭辞の次のByte毎に
+  * 部分DoubleArrayを各Threadで構築し、Indexをずらして1つにまとめる
+  * @param add_datas      DoubleArray構築データ
+  * @param i_option       構築オプション
+  * @param i_thread_count Thread数 0 : 実行環境のCore数
+  * @return 0 : 正常終了  0以外 : 異常終了
+  */
+  int createDoubleArray(
+    ByteArrays& add_datas,
+    const int i_option,
+    const unsigned int i_thread_count) noexcept;
+
+  /** 整列済みのデータを順に読み込みながらDoubleArrayを構築する
+  * 全データを保持せず、子が確定したNodeから配置するので、
+  * 作業領域は最長データ長に比例する分だけで済む。
+  * データはByte単位(unsigned)の辞書順に並んでいること。同一データは後のものを使う
+  * @param read_data 次のデータを取得する関数
+  * @param i_option  構築オプション
+  * @return 0 : 正常終了  I_FAILED_TRIE : 整列されていない  それ以外 : 異常終了
+  */
+  int createDoubleArray(
+    const ReadFunction& read_data,
+    const int i_option = I_NO_OPTION) noexcept;
+
+  /** 整列済みのテキストファイルからDoubleArrayを構築する
+  * 1行1データで "データ<TAB>結果" の形式。TABが無い行は行番号(1始まり)を結果にする
+  * @param c_file_path ファイルパス
+  * @param i_option    構築オプション
+  * @return 0 : 正常終了  I_FAILED_TRIE : 整列されていない  それ以外 : 異常終了
+  */
+  int createDoubleArray(
+    const char* c_file_path,
+    const int i_option = I_NO_OPTION) noexcept;
+
   /** 検索する
   * c_byteにはNULLが途中に含まれる可能性がある為、
   * バイト長も渡さないとダメ。
@@ -74,6 +181,32 @@ public:
     const char* c_byte,
     const uint64_t i_byte_length) const noexcept;
 
+  /** I_KEY_IDで構築したDoubleArrayからKey IDを取得する
+  * Key IDは0始まりの辞書順の連番。searchなど他の検索はKey ID+1を結果として返す
+  * @param c_byte        search bytes
+  * @param i_byte_length search data length
+  * @return Key ID  -1 : 該当無し
+  */
+  int64_t searchKeyId(
+    const char* c_byte,
+    const uint64_t i_byte_length) const noexcept;
+
+  /** 複数データを一括で検索する
+  * I_BATCH_WIDTH件ずつ1Byteごとに交互に進め、次に参照する
+  * Base/Check/Tailを先読みしてメモリ待ちを重ねる。
+  * searchと異なりc_bytesの末尾に終端記号は必要としない
+  * @param c_bytes        search bytes配列
+  * @param i_byte_lengths search data length配列
+  * @param i_count        検索データ数
+  * @param results        search result配列 i_count分の領域が必要
+  * @return
+  */
+  void searchBatch(
+    const char* const* c_bytes,
+    const uint64_t* i_byte_lengths,
+    const uint64_t i_count,
+    int64_t* results) const noexcept;
+
   /** 途中経過状態を取得しながら検索する
   * @param sarch_parts   search position
   * @param result        search result
@@ -87,7 +220,78 @@ public:
     const char* c_byte,
     const uint64_t i_byte_length) const noexcept;
 
+  /** 共通接頭辞検索 c_byteの先頭に一致する全てのデータを一度の走査で求める
+  * c_byteは終端記号を必要としない
+  * @param c_byte        search bytes
+  * @param i_byte_length search data length
+  * @param results       一致したデータの検索結果と一致長 短い順
+  * @param i_max_results resultsに格納する最大数
+  * @return 一致したデータ数 i_max_resultsを超える場合もある
+  */
+  uint64_t commonPrefixSearch(
+    const char* c_byte,
+    const uint64_t i_byte_length,
+    DAPrefixResult* results,
+    const uint64_t i_max_results) const noexcept;
+
+  /** テキストを先頭から最長一致するデータで区切る
+  * 1Tokenにつき1回だけRootから辿り、Tailの途中までを含めて最後に終端へ到達した位置を使う。
+  * どのデータにも一致しない連続したByteは結果I_SEARCH_NOHITの1Tokenにまとめる。
+  * tokensが一杯になった時点で終了するので、続きは最後のTokenの終了位置から再開する
+  * @param c_text        区切るテキスト 終端記号を必要としない
+  * @param i_text_length テキストのバイト長
+  * @param tokens        区切ったToken テキスト中の位置順
+  * @param i_max_tokens  tokensに格納する最大数
+  * @return tokensに格納したToken数
+  */
+  uint64_t tokenizeLongest(
+    const char* c_text,
+    const uint64_t i_text_length,
+    DAToken* tokens,
+    const uint64_t i_max_tokens) const noexcept;
+
+  /** 予測検索を開始する c_byteで始まる全てのデータを辞書順に列挙する準備をする
+  * 列挙はpredictiveNextで行う
+  * @param predictive_parts 列挙状態
+  * @param c_byte           接頭辞 終端記号は必要としない
+  * @param i_byte_length    接頭辞の長さ
+  * @param i_max_results    列挙する最大数
+  * @return true : 接頭辞に一致するデータがある  false : 無い
+  */
+  bool predictiveSearch(
+    DAPredictiveParts& predictive_parts,
+    const char* c_byte,
+    const uint64_t i_byte_length,
+    const uint64_t i_max_results = std::numeric_limits<uint64_t>::max()) const noexcept;
+
+  /** 予測検索の次のデータを取得する
+  * 一致したByte情報はpredictive_parts.c_key_に格納し、データ毎のメモリ確保はしない
+  * @param predictive_parts 列挙状態
+  * @param result           search result
+  * @return true : 取得できた  false : 列挙終了
+  */
+  bool predictiveNext(
+    DAPredictiveParts& predictive_parts,
+    int64_t& result) const noexcept;
+
+  /** 編集距離がi_max_edits以内の全てのデータを辞書順に求める
+  * 子を辿る毎に編集距離の表を1行追加し、行の最小値が上限を超えた部分木は辿らない。
+  * 距離に余裕が無いNodeでは、検索Byte列に含まれるByteの子だけを調べる。
+  * 挿入・削除・置換をそれぞれ距離1とする
+  * @param c_byte        search bytes 終端記号を必要としない
+  * @param i_byte_length search data length
+  * @param i_max_edits   許容する編集距離
+  * @param found         見つかったデータを受け取る関数
+  * @return foundを呼び出した回数
+  */
+  uint64_t fuzzySearch(
+    const char* c_byte,
+    const uint64_t i_byte_length,
+    const uint64_t i_max_edits,
+    const FuzzyFunction& found) const noexcept;
+
   /** DoubleArray情報を書き込む
+  * ヘッダ付きのVersion管理された形式で、各配列はI_PAGE_SIZE境界に配置する
   * @param i_write_size 書き込んだデータサイズ
   * @param fp           OutputFileStream
   * @return I_DA_NO_ERROR : 正常終了 0以外 : 異常終了
@@ -97,6 +301,7 @@ public:
     FILE* fp) const noexcept;
 
   /** DoubleArray情報を読み込む
+  * ヘッダの無い旧形式のデータも読み込める
   * @param i_read_size 読み込んだデータサイズ
   * @param fp          InputFileStream
   * @return I_DA_NO_ERROR : 正常終了 0以外 : 異常終了
@@ -105,7 +310,26 @@ public:
     int64_t& i_read_size,
     FILE* fp) noexcept;
 
+  /** writeBinaryで書き込んだファイルをmmapして検索可能にする
+  * 配列はコピーせずにmmap領域を直接参照するので、
+  * 同一ファイルを開いたプロセス間でページキャッシュを共有できる
+  * @param c_file_path   ファイルパス
+  * @param i_file_offset writeBinaryで書き込みを開始したファイル位置
+  * @return I_NO_ERROR : 正常終了 0以外 : 異常終了
+  */
+  int openMapped(
+    const char* c_file_path,
+    const uint64_t i_file_offset = 0) noexcept;
+
+  /** mmapした領域を参照しているかチェック
+  * @param
+  * @return true : mmap領域を参照  false : 自前でメモリ確保
+  */
+  bool checkMapped() const noexcept;
+
   /** 内部データを取得する
+  * I_UNIT_LAYOUTで構築した場合、i_base/i_checkはnullptrになる
+  * I_CODE_TABLEで構築した場合、Base/Checkの遷移はByteをCode表で変換した値で行う
   * @param i_array_size  配列サイズ
   * @param i_tail_size   Tail文字列サイズ
   * @param i_result_size Tail結果サイズ
@@ -135,9 +359,9 @@ public:
   * @return
   */
   int setDoubleArrayData(
-    int i_array_size,
-    int i_tail_size,
-    int i_result_size,
+    uint64_t i_array_size,
+    uint64_t i_tail_size,
+    uint64_t i_result_size,
     const int* i_base,
     const int* i_check,
     const int64_t* i_result,
@@ -149,8 +373,59 @@ public:
   */
   bool checkInit() const noexcept;
 
+  /** データを追加する 既に存在する場合は結果を更新する
+  * 分岐先が他のNodeと衝突した場合は子の少ない方のNodeを再配置し、
+  * Tailの途中で分岐する場合は共通部分をNodeにしてTailを分割する。
+  * I_UNIT_LAYOUTで構築した場合とmmap領域を参照している場合は未対応
+  * @param c_byte        追加するByte列 終端記号は必要としない
+  * @param i_byte_length 追加するByte長
+  * @param result        検索結果 I_TAIL_UNITYで構築した場合は使用しない
+  * @return I_NO_ERROR : 正常終了  I_NOT_SUPPORTED : 未対応の形式  それ以外 : 異常終了
+  */
+  int insert(
+    const char* c_byte,
+    const uint64_t i_byte_length,
+    const int64_t result) noexcept;
+
+  /** データを削除する
+  * 子が無くなったNodeも削除する。使われなくなったTailの領域は再利用しない
+  * @param c_byte        削除するByte列 終端記号は必要としない
+  * @param i_byte_length 削除するByte長
+  * @return true : 削除した  false : 存在しない or 未対応の形式
+  */
+  bool erase(
+    const char* c_byte,
+    const uint64_t i_byte_length) noexcept;
+
+  /** 結果からLeafを引く逆引きIndexを作成する
+  * 作成後のreproductionFromIndexは全要素の走査をせず、二分探索とデータ長分の遡りで済む。
+  * insert, eraseを行うと破棄されるので、必要なら再度作成する
+  * @return I_NO_ERROR : 正常終了  I_NOT_SUPPORTED : 結果を持たない or mmap領域  それ以外 : 異常終了
+  */
+  int createReverseIndex() noexcept;
+
+  /** scan用の失敗遷移, 出力遷移の表を作成する
+  * NodeとTailの各Byteを状態とし、幅優先で失敗遷移を求める。
+  * insert, eraseを行うと破棄されるので、必要なら再度作成する
+  * @return I_NO_ERROR : 正常終了  I_NOT_SUPPORTED : I_SHARE_TAILで構築 or 状態数超過  それ以外 : 異常終了
+  */
+  int createScanTable() noexcept;
+
+  /** テキスト中に現れる全てのデータを1回の走査で探す (Aho-Corasick)
+  * 同じ終了位置では長い一致から順に通知する。createScanTableが必要
+  * @param c_text        走査するテキスト
+  * @param i_text_length テキストのバイト長
+  * @param found         一致毎に呼び出す関数
+  * @return 通知した一致数
+  */
+  uint64_t scan(
+    const char* c_text,
+    const uint64_t i_text_length,
+    const ScanFunction& found) const noexcept;
+
   /** 結果IndexからByte情報を復元する
-  * @param c_info         復元したByte情報 呼び出し側でdeleteする
+  * 同じ結果を持つデータが複数ある場合はTail上で後ろにあるものを返す
+  * @param c_info         復元したByte情報 呼び出し側でdeleteする 該当無しはnullptr
   * @param i_result_index 復元する結果Index
   * @return
   */
@@ -158,6 +433,25 @@ public:
     char*& c_info,
     const int64_t i_result_index) const noexcept;
 
+  /** 配置の統計と直近の構築の記録を求める
+  * 全要素を1回走査するので、検索の合間に頻繁に呼ぶものではない
+  * @param stats 統計情報
+  * @return I_NO_ERROR : 正常終了  それ以外 : 異常終了
+  */
+  int getStats(
+    DAStats& stats) const noexcept;
+
+  /** 検索Counterを取得する 全DoubleArrayのsearchの合計
+  * DA_ENABLE_LOOKUP_COUNTERSを定義してDoubleArray.cppをcompileした場合だけ数える
+  * @param counters 検索Counter
+  * @return I_NO_ERROR : 正常終了  I_NOT_SUPPORTED : Counter無効
+  */
+  static int getLookupCounters(
+    DALookupCounters& counters) noexcept;
+
+  /** 検索Counterを0に戻す */
+  static void resetLookupCounters() noexcept;
+
 private:
   /** メモリ確保
   * @param b_init_size サイズを初期化するか
@@ -180,6 +474,145 @@ private:
   int baseCheckExtendMemory(
     const uint64_t i_lower_limit) noexcept;
 
+  /** Base値を取得する 配置形式の違いを吸収する
+  * @param i_index BaseCheckIndex
+  * @return Base値
+  */
+  int getBase(
+    const int i_index) const noexcept;
+
+  /** Check値を取得する 配置形式の違いを吸収する
+  * @param i_index BaseCheckIndex
+  * @return Check値
+  */
+  int getCheck(
+    const int i_index) const noexcept;
+
+  /** Base/Checkを先読みする
+  * @param i_index BaseCheckIndex
+  * @return
+  */
+  void prefetchNode(
+    const int i_index) const noexcept;
+
+  /** Byteを遷移に使うCodeに変換する I_CODE_TABLE以外は値そのまま
+  * @param c_byte 変換するByte
+  * @return 遷移Code
+  */
+  int getCode(
+    const char c_byte) const noexcept;
+
+  /** 構築データのByteの出現頻度からCode表を作成する
+  * 終端記号は0のまま、他は出現数の多い順に1から割り当てる
+  * @param c_code_table Byte→Codeの表
+  * @param c_code_bytes Code→Byteの表
+  * @param add_datas    DoubleArray構築データ
+  * @return
+  */
+  static void createCodeTable(
+    unsigned char* c_code_table,
+    unsigned char* c_code_bytes,
+    const ByteArrays& add_datas) noexcept;
+
+  /** 構築データのByteを表で置き換える
+  * @param add_datas    DoubleArray構築データ
+  * @param c_code_table 置き換える表
+  * @return
+  */
+  static void encodeByteArrays(
+    ByteArrays& add_datas,
+    const unsigned char* c_code_table) noexcept;
+
+  /** Codeで構築した後にCode表を設定し、TailをByteに戻す
+  * 遷移だけをCodeで行い、Tailは元のByteのまま比較する
+  * @param c_code_table      Byte→Codeの表
+  * @param c_code_bytes      Code→Byteの表
+  * @param i_tail_last_index Tail配列のデータが格納されている最終Index
+  * @return
+  */
+  void setCodeTable(
+    const unsigned char* c_code_table,
+    const unsigned char* c_code_bytes,
+    const int i_tail_last_index) noexcept;
+
+  /** 読み込んだCode表が置換になっているか確認し、逆引きの表を作る
+  * @param
+  * @return true : 正しいCode表  false : 不正
+  */
+  bool checkCodeTable() noexcept;
+
+  /** Base/Check配列をUnit形式に変換する
+  * @param
+  * @return Error Code
+  */
+  int convertUnitLayout() noexcept;
+
+  /** 同じ結果を持つTailのうち、他のTailの末尾と一致するものは共有する
+  * Tailを末尾から比較した順に並べ、直後のTailの末尾に含まれるものをそこへ重ねる。
+  * 共有後はinsert, eraseできない
+  * @param
+  * @return Error Code
+  */
+  int convertSharedTail() noexcept;
+
+  /** TailをKeyの辞書順に並べ替え、終端記号の順位をKey IDにする
+  * 結果配列は持たず、I_SHARE_TAILとI_TAIL_UNITYは無視する
+  * @param
+  * @return Error Code
+  */
+  int convertKeyId() noexcept;
+
+  /** Leafが指すTail終端記号の位置をbit列にする
+  * @param i_result_count 終端記号の数
+  * @return Error Code
+  */
+  int createResultBlocks(
+    uint64_t& i_result_count) noexcept;
+
+  /** Tail終端記号より前にある結果を持つ終端記号の数を求める
+  * @param i_tail_index Tail終端記号のIndex
+  * @return 順位 0始まり
+  */
+  uint64_t getResultRank(
+    const uint64_t i_tail_index) const noexcept;
+
+  /** Tail位置毎の結果配列をKey毎の詰めた配列に変換する
+  * Tail終端記号の位置をbit列で持ち、そのrankで結果を引く。
+  * 結果は最小値からの差分を必要なbit幅で詰める
+  * @param
+  * @return Error Code
+  */
+  int convertCompactResult() noexcept;
+
+  /** 詰めた結果配列から検索結果を取得する I_KEY_IDの場合は順位+1
+  * @param i_tail_index Tail終端記号のIndex
+  * @return search result
+  */
+  int64_t getCompactResult(
+    const uint64_t i_tail_index) const noexcept;
+
+  /** Unit形式で検索する
+  * @param c_byte        search bytes
+  * @param i_byte_length search data length
+  * @return search result
+  */
+  int64_t searchUnit(
+    const char* c_byte,
+    const uint64_t i_byte_length) const noexcept;
+
+  /** 検索のTail処理
+  * @param i_tail_index  Tail開始Index
+  * @param c_byte        search bytes
+  * @param i_byte_index  Tail突入契機のByte位置
+  * @param i_byte_length search data length
+  * @return search result
+  */
+  int64_t searchTail(
+    const uint64_t i_tail_index,
+    const char* c_byte,
+    uint64_t i_byte_index,
+    const uint64_t i_byte_length) const noexcept;
+
   /** Tailのメモリ拡張
   * @param i_lower_limit 拡張最低領域
   * @return Error Code
@@ -194,38 +627,120 @@ private:
   int optimizeMemory(
     const int i_tail_last_index) noexcept;
 
+  /** 全データ共通の接頭辞の次のByte毎に部分DoubleArrayを並列に構築してまとめる
+  * オプションは適用しない
+  * @param i_tail_index   Tail配列のデータが格納されている最終Index
+  * @param add_datas      DoubleArray構築データ 整列する
+  * @param i_thread_count Thread数 0 : 実行環境のCore数
+  * @return Error Code
+  */
+  int createParallelDoubleArray(
+    int& i_tail_index,
+    ByteArrays& add_datas,
+    const unsigned int i_thread_count) noexcept;
+
+  /** 整列済みデータからDoubleArrayを構築する オプションは適用しない
+  * @param i_tail_index 書き込んだ次のTailIndex
+  * @param datas        構築データ 整列済み
+  * @param i_data_count データ数
+  * @return Error Code
+  */
+  int createSortedDoubleArray(
+    int& i_tail_index,
+    const ByteArray* datas,
+    const uint64_t i_data_count) noexcept;
+
+  /** 部分DoubleArrayを再配置して1つにまとめる
+  * Rootから共通接頭辞までを先頭に配置し、分岐Nodeの子の位置に
+  * 各部分の該当Nodeを置く。残りはIndexをずらして後ろに連結する
+  * @param i_tail_index    書き込んだ次のTailIndex
+  * @param datas           構築データ 整列済み
+  * @param i_prefix_length 全データ共通の接頭辞の長さ
+  * @param sub_arrays      分岐Byte毎の部分DoubleArray 再配置したものは破棄する
+  * @return Error Code
+  */
+  int mergeDoubleArrays(
+    int& i_tail_index,
+    const ByteArray* datas,
+    const uint64_t i_prefix_length,
+    std::vector<DASubArray>& sub_arrays) noexcept;
+
+  /** 構築後の共通処理 オプションを適用してメモリを最適化する
+  * @param i_tail_index Tail配列のデータが格納されている最終Index
+  * @param i_option     構築オプション
+  * @return Error Code
+  */
+  int completeDoubleArray(
+    const int i_tail_index,
+    const int i_option) noexcept;
+
+  /** 子が全て確定したNodeを閉じる 子のBase値を決めて配置し、親の子にする
+  * 自身の位置は親を閉じるまで決まらないので、子のCheckは親を閉じた時に設定する
+  * @param empty_slots 空き要素情報
+  * @param nodes       Rootからの開いているNode
+  * @param i_depth     閉じるNodeの深さ 0 : Root
+  * @param c_label     閉じるNodeへ遷移するByte
+  * @return Error Code
+  */
+  int closeStreamNode(
+    DAEmptySlots& empty_slots,
+    std::vector<DAStreamNode>& nodes,
+    const uint64_t i_depth,
+    const unsigned char c_label) noexcept;
+
   /** 入力データからTRIE構造を構築する
-  * @param root_node   構築したTrie Root Node
-  * @param byte_arrays 基にするデータ
-  * @return
+  * NodeはArenaから確保し、Tailは入力データを指すだけでCopyしない
+  * @param root_node      構築したTrie Root Node
+  * @param arena          Node, NodePartsの確保先
+  * @param datas          基にするデータ 整列済み DoubleArray構築完了まで保持すること
+  * @param i_data_count   データ数
+  * @param i_overlap_time 重複Index情報の作成にかかった時間 nano秒
+  * @return Error Code
   */
-  void createTrie(
+  int createTrie(
     TrieNode*& root_node,
-    const ByteArrays& byte_arrays) const noexcept;
+    DABuildArena& arena,
+    const ByteArray* datas,
+    const uint64_t i_data_count,
+    uint64_t& i_overlap_time) const noexcept;
 
-  /** Trie構造から再帰的にDoubleArrayを構築する
+  /** Trie構造からDoubleArrayを構築する
+  * 再帰はせず、作業Stackで深さ優先に辿るので長いKeyでもStackを消費しない
   * @param i_tail_index 書き込み開始TailIndex
-  * @param base_array   BaseValueの値を決定するのに使用
-  * @param trie_node    Current TrieNode
-  * @param i_base_index 基準のBaseCheckIndex
+  * @param empty_slots  空き要素情報 BaseValueの値を決定するのに使用
+  * @param root_node    Trie Root Node
   * @return Error Code
   */
-  int recursiveCreateDoubleArray(
+  int createDoubleArrayFromTrie(
     int& i_tail_index,
-    unsigned int* base_array,
-    TrieNode* trie_node,
-    const int i_base_index) noexcept;
+    DAEmptySlots& empty_slots,
+    const TrieNode* root_node) noexcept;
 
-  /** Baseの値を求める ついでにtarget layer rangeも求める
+  /** 兄弟NodeのBase値を決めてCheckを設定する
   * @param i_base_value 求めたBase値
-  * @param base_array   BaseValueの値を決定するのに使用
-  * @param trie_node    対象のTrieNodeIndex
+  * @param empty_slots  空き要素情報
+  * @param trie_node    兄弟Nodeの先頭
+  * @param i_base_index 親のBaseCheckIndex
+  * @return Error Code
+  */
+  int setBranchNode(
+    unsigned int& i_base_value,
+    DAEmptySlots& empty_slots,
+    const TrieNode* trie_node,
+    const int i_base_index) noexcept;
+
+  /** Baseの値を求める 空き要素からのみ候補を探し、使用した要素は空きから外す
+  * @param i_base_value  求めたBase値
+  * @param empty_slots   空き要素情報
+  * @param c_labels      分岐するByte 昇順
+  * @param i_label_count 分岐数
   * @return Error Code
   */
   int getBaseValue(
     unsigned int& i_base_value,
-    unsigned int* base_array,
-    const TrieNode* trie_node) noexcept;
+    DAEmptySlots& empty_slots,
+    const unsigned char* c_labels,
+    const int i_label_count) noexcept;
 
   /** Tailに情報を設定する
   * @param i_tail_index Tail格納開始位置
@@ -236,18 +751,216 @@ private:
     int& i_tail_index,
     const NodeParts* node_parts) noexcept;
 
+  /** Binary形式のヘッダ情報を作成する
+  * @param header 作成したヘッダ情報
+  * @return
+  */
+  void createFileHeader(
+    DAFileHeader& header) const noexcept;
+
+  /** Sectionのバイトサイズを現在の各サイズから求める
+  * @param i_section Section番号
+  * @return バイトサイズ 0 : 該当Section無し
+  */
+  uint64_t getSectionSize(
+    const int i_section) const noexcept;
+
+  /** Sectionに対応する配列を取得する
+  * @param i_section Section番号
+  * @return 配列の先頭 該当配列が無い場合はnullptr
+  */
+  char* getSectionData(
+    const int i_section) const noexcept;
+
+  /** Sectionに対応する配列を設定する mmap領域の参照に使用
+  * @param i_section Section番号
+  * @param c_data    配列の先頭
+  * @return
+  */
+  void setSectionData(
+    const int i_section,
+    char* c_data) noexcept;
+
+  /** ヘッダ情報を基にサイズを設定してSection毎に読み込む
+  * @param i_read_size 読み込んだデータサイズ
+  * @param header      読み込んだヘッダ情報
+  * @param fp          InputFileStream
+  * @return Error Code
+  */
+  int readSections(
+    int64_t& i_read_size,
+    const DAFileHeader& header,
+    FILE* fp) noexcept;
+
+  /** Nodeに子を追加する 衝突した場合は再配置する
+  * @param i_base_index 親のBaseCheckIndex 再配置で移動した場合は移動先
+  * @param c_label      追加するByte
+  * @param i_insert     追加した子のBaseCheckIndex
+  * @return Error Code
+  */
+  int addChild(
+    int& i_base_index,
+    const unsigned char c_label,
+    int& i_insert) noexcept;
+
+  /** 子を全て置けるBase値を空き要素から探す 配列が不足した場合は拡張する
+  * 途中の要素はI_FREE_SEARCH_LIMIT個だけ試し、置けなければ使用済みの末尾の後ろに置く。
+  * 試して置けなかった範囲は次回から探さないので、1回あたりの探索量に上限ができる
+  * @param i_base_value  求めたBase値
+  * @param c_labels      子のByte 昇順
+  * @param i_label_count 子の数
+  * @return Error Code
+  */
+  int findFreeBase(
+    unsigned int& i_base_value,
+    const unsigned char* c_labels,
+    const int i_label_count) noexcept;
+
+  /** Nodeの子を別のBase値の位置に移す
+  * @param i_base_index  移すNodeのBaseCheckIndex
+  * @param i_base_value  移動先のBase値
+  * @param c_labels      子のByte
+  * @param i_label_count 子の数
+  * @return
+  */
+  void relocateNode(
+    const int i_base_index,
+    const unsigned int i_base_value,
+    const unsigned char* c_labels,
+    const int i_label_count) noexcept;
+
+  /** Nodeの子のByteを取得する
+  * @param c_labels     子のByte 昇順 256要素必要
+  * @param i_base_index NodeのBaseCheckIndex
+  * @return 子の数
+  */
+  int getChildLabels(
+    unsigned char* c_labels,
+    const int i_base_index) const noexcept;
+
+  /** Tail末尾にByte列と終端記号を追加する
+  * @param i_tail_index  追加したTailの開始Index
+  * @param c_byte        追加するByte列 終端記号は含まない
+  * @param i_byte_length 追加するByte長
+  * @param result        検索結果
+  * @return Error Code
+  */
+  int appendTail(
+    int& i_tail_index,
+    const char* c_byte,
+    const uint64_t i_byte_length,
+    const int64_t result) noexcept;
+
+  /** 逆引きIndexを破棄する mmap領域の場合は参照を外すだけ
+  * @return
+  */
+  void deleteReverseIndex() noexcept;
+
+  /** 逆引きIndexから結果に対応するLeafを探す
+  * @param i_result_index 探す結果Index
+  * @return LeafのBaseCheckIndex 0 : 該当無し
+  */
+  uint64_t findReverseLeaf(
+    const int64_t i_result_index) const noexcept;
+
+  /** c_byteの先頭に一致する最長のデータを求める
+  * @param i_length      一致したバイト長
+  * @param result        search result
+  * @param c_byte        search bytes
+  * @param i_byte_length search data length
+  * @return true : 一致するデータ有り
+  */
+  bool searchLongest(
+    uint64_t& i_length,
+    int64_t& result,
+    const char* c_byte,
+    const uint64_t i_byte_length) const noexcept;
+
+  /** 編集距離の表に1Byte分の行を追加する
+  * @param i_rows        編集距離の表 1行はi_byte_length+1要素
+  * @param c_byte        search bytes
+  * @param i_byte_length search data length
+  * @param c_label       追加するByte
+  * @return 追加した行の最小値
+  */
+  uint64_t appendFuzzyRow(
+    std::vector<uint64_t>& i_rows,
+    const char* c_byte,
+    const uint64_t i_byte_length,
+    const char c_label) const noexcept;
+
+  /** scan用の表を破棄する
+  * @return
+  */
+  void deleteScanTable() noexcept;
+
+  /** scanの状態から1Byte遷移する
+  * @param i_state 状態 i_array_size_未満はNode、それ以上はTail位置+i_array_size_
+  * @param c_label 遷移するByte
+  * @return 遷移先の状態 -1 : 遷移できない
+  */
+  int getScanNext(
+    const int i_state,
+    const unsigned char c_label) const noexcept;
+
+  /** scanの状態で終わるデータがあれば結果を取得する
+  * @param result  search result
+  * @param i_state 状態
+  * @return true : データの終端
+  */
+  bool getScanResult(
+    int64_t& result,
+    const int i_state) const noexcept;
+
+  /** Tail終端位置から検索結果を取得する
+  * @param i_tail_index Tail終端記号のIndex
+  * @return search result
+  */
+  int64_t getTailResult(
+    const uint64_t i_tail_index) const noexcept;
+
   /** SameIndex情報を作成
   * @param i_max_length 最長データ長
   * @param positions    start,tail Indexx
   * @param datas        全追加データ
+  * @param i_data_count データ数
   * @return
   */
   void createOverlapPositions(
     uint64_t& i_max_length,
     std::vector<std::pair<uint64_t, uint64_t>>& positions,
-    const ByteArrays& datas) const noexcept;
+    const ByteArray* datas,
+    const uint64_t i_data_count) const noexcept;
+
+  /** 構築の記録を0に戻す */
+  void resetBuildStats() noexcept;
+
+  /** 経過時間を求める
+  * @param start 開始時刻
+  * @return 経過時間 nano秒
+  */
+  static uint64_t getElapsedTime(
+    const std::chrono::steady_clock::time_point& start) noexcept;
+
+  /** searchの経過を検索Counterに加える DA_ENABLE_LOOKUP_COUNTERSが無ければ何もしない
+  * @param i_transitions 試したBase/Check遷移数
+  * @param b_tail        Tailを比較したか
+  * @param b_miss        該当無しか
+  * @param i_depth       遷移を終えたByte位置
+  */
+  static void countLookup(
+    const uint64_t i_transitions,
+    const bool b_tail,
+    const bool b_miss,
+    const uint64_t i_depth) noexcept;
 
 private:
+  /** 幅を変えた検索用Imageへの変換で内部配列を参照する */
+  template<class IndexT, class ValueT> friend class BasicDoubleArray;
+
+  /** 1Byteずつの遷移でBase/Check/Tailを直接参照する */
+  friend class DACursor;
+
   /** BASE配列 */
   int* i_base_;
 
@@ -260,6 +973,27 @@ private:
   /** 結果配列 */
   int64_t* i_result_;
 
+  /** Base/Checkをまとめた配列 I_UNIT_LAYOUT時のみ使用 */
+  DAUnit* units_;
+
+  /** 結果順に整列した逆引きIndex 未作成時はnullptr */
+  DAReverseEntry* reverse_index_;
+
+  /** 逆引きIndexの要素数 */
+  uint64_t i_reverse_size_;
+
+  /** scan用の状態毎の遷移表 未作成時はnullptr */
+  DAScanState* scan_states_;
+
+  /** 結果を持つTail終端記号の位置 I_COMPACT_RESULT, I_KEY_ID時のみ使用 */
+  DAResultBlock* result_blocks_;
+
+  /** bit幅を詰めた結果配列 先頭2要素は最小値とbit幅 I_COMPACT_RESULT時のみ使用 */
+  uint64_t* i_packed_result_;
+
+  /** 詰めた結果配列の要素数 */
+  uint64_t i_packed_size_;
+
   /** 要素数サイズ */
   uint64_t i_array_size_;
 
@@ -268,6 +1002,39 @@ private:
 
   /** Tail結果配列サイズ */
   uint64_t i_result_size_;
+
+  /** 配置形式に関わる構築オプション */
+  int i_option_;
+
+  /** Byte→遷移Codeの表 I_CODE_TABLE以外は恒等 */
+  unsigned char c_code_table_[256];
+
+  /** 遷移Code→Byteの表 */
+  unsigned char c_code_bytes_[256];
+
+  /** mmap領域 未使用時はnullptr */
+  void* p_mapped_;
+
+  /** mmap領域サイズ */
+  uint64_t i_mapped_size_;
+
+  /** Tailの使用済みサイズ insert時に求める 0 : 未計算 */
+  uint64_t i_tail_used_;
+
+  /** insert時に空き要素を探し始めるIndex */
+  uint64_t i_free_index_;
+
+  /** insert時の使用済み要素の末尾 これ以降は全て空き 0 : 未計算 */
+  uint64_t i_free_end_;
+
+  /** 直近の構築からのBaseCheck配列の拡張回数 */
+  uint64_t i_base_check_extends_;
+
+  /** 直近の構築からのTail配列の拡張回数 */
+  uint64_t i_tail_extends_;
+
+  /** 直近の構築の段階毎の時間 nano秒 */
+  uint64_t i_build_times_[I_PHASE_COUNT];
 };
 
 /** 検索経過状態情報 */
@@ -302,31 +1069,404 @@ public:
   int i_tail_;
 };
 
-/** Trie Node */
-class TrieNode
+/** DACursorの位置 snapshot/restoreで保存・復元する */
+class DACursorState
 {
 public:
-  /** initのみ */
-  TrieNode(unsigned char c_byte) noexcept : c_byte_(c_byte), p_same_layer_(nullptr), p_child_top_(nullptr), node_parts_(nullptr) {}
+  /** 無効な位置 */
+  DACursorState() noexcept : i_node_(DoubleArray::I_ARRAY_NO_DATA), i_tail_(0), i_depth_(0) {}
 
-  /** initのみ */
-  TrieNode(unsigned char c_byte, TrieNode* p_same_layer, TrieNode* p_next, NodeParts* node_parts) noexcept
-    : c_byte_(c_byte), p_same_layer_(p_same_layer), p_child_top_(p_next), node_parts_(node_parts) {}
+  /** init */
+  DACursorState(const int i_node, const uint64_t i_tail, const uint64_t i_depth) noexcept
+    : i_node_(i_node), i_tail_(i_tail), i_depth_(i_depth) {}
 
-  /** cost削減のためvirtualは付加しない */
-  ~TrieNode() noexcept {}
+public:
+  /** 現在のBaseCheckIndex Tail中はLeaf  I_ARRAY_NO_DATA : 続くデータが無い */
+  int i_node_;
 
-  /** move */
-  TrieNode(TrieNode&& trie_node) noexcept
-    : c_byte_(trie_node.c_byte_),
-      p_same_layer_(trie_node.p_same_layer_),
-      p_child_top_(trie_node.p_child_top_),
-      node_parts_(trie_node.node_parts_) {}
+  /** 次に照合するTail位置 0 : Tailに入っていない */
+  uint64_t i_tail_;
 
-  /** = operator */
-  TrieNode& operator = (const TrieNode& trie_node)
-  {
-    c_byte_       = trie_node.c_byte_;
+  /** Rootから進んだByte数 */
+  uint64_t i_depth_;
+};
+
+/**
+ * DoubleArrayを1Byteずつ辿るCursor<br/>
+ * 入力の度に先頭から検索し直さずに済むので、1文字ずつの補完候補の絞り込みや、<br/>
+ * 区切りの分からないStreamの照合に使う。<br/>
+ * Tailに入った後もTail位置を1つ進めるだけなので、stepは常にO(1)。<br/>
+ * 参照中のDoubleArrayを変更してはならない
+ */
+class DACursor
+{
+public:
+  /** Rootに置く
+  * @param double_array 辿るDoubleArray
+  */
+  explicit DACursor(
+    const DoubleArray& double_array) noexcept;
+
+  /** Rootに戻す */
+  void reset() noexcept;
+
+  /** 1Byte進める 続くデータが無ければ以降は無効のまま
+  * @param c_byte 次のByte
+  * @return true : この位置までを接頭辞に持つデータがある
+  */
+  bool step(
+    const char c_byte) noexcept;
+
+  /** 複数Byte進める
+  * @param c_byte        次のByte列
+  * @param i_byte_length Byte長
+  * @return true : この位置までを接頭辞に持つデータがある
+  */
+  bool step(
+    const char* c_byte,
+    const uint64_t i_byte_length) noexcept;
+
+  /** ここまでを接頭辞に持つデータがあるかチェック */
+  bool isValid() const noexcept { return state_.i_node_ != DoubleArray::I_ARRAY_NO_DATA; }
+
+  /** ここまでのByte列が登録データかチェック
+  * @return true : 登録データ
+  */
+  bool isTerminal() const noexcept;
+
+  /** ここまでのByte列の検索結果を取得する
+  * @return search result  登録データでなければI_SEARCH_NOHIT
+  */
+  int64_t value() const noexcept;
+
+  /** 次に進めるByteを昇順に求める Tail中は高々1つ
+  * @param c_labels 次のByte 256要素分の領域が必要
+  * @return 次のByteの数
+  */
+  uint64_t children(
+    unsigned char* c_labels) const noexcept;
+
+  /** Rootから進んだByte数 */
+  uint64_t getDepth() const noexcept { return state_.i_depth_; }
+
+  /** 現在の位置を保存する */
+  DACursorState snapshot() const noexcept { return state_; }
+
+  /** 保存した位置に戻す
+  * @param state snapshotで保存した位置
+  */
+  void restore(const DACursorState& state) noexcept { state_ = state; }
+
+private:
+  /** 現在のNodeから終端記号で遷移したLeaf
+  * @return Tail終端記号の位置  0 : 無し
+  */
+  uint64_t getTerminalTail() const noexcept;
+
+private:
+  /** 辿るDoubleArray */
+  const DoubleArray& double_array_;
+
+  /** 現在の位置 */
+  DACursorState state_;
+};
+
+/** BaseとCheckを隣接させたNode
+* 1回の遷移で参照するCache lineを1本にする。
+* Leafかどうかはi_base_の符号で表し、LabelはCheckの親Indexで照合する
+*/
+class DAUnit
+{
+public:
+  /** base値 マイナス値はTailIndex */
+  int i_base_;
+
+  /** check値 親のBaseCheckIndex */
+  int i_check_;
+};
+
+/** Tail終端記号の位置を示すbit列 I_BLOCK_SIZE Byte毎に先頭までの個数を持つ */
+class DAResultBlock
+{
+public:
+  static constexpr uint64_t I_WORD_COUNT = 4;                 /* bit列のWord数       */
+  static constexpr uint64_t I_BLOCK_SIZE = I_WORD_COUNT * 64; /* 1BlockのTail Byte数 */
+
+public:
+  /** このBlockより前にある結果の数 */
+  uint64_t i_rank_;
+
+  /** Tail Byte毎のbit 1 : 結果を持つ終端記号 */
+  uint64_t i_bits_[I_WORD_COUNT];
+};
+
+/** 逆引きIndexの要素 結果, Tail終端位置の順に整列する */
+class DAReverseEntry
+{
+public:
+  /** search result */
+  int64_t i_result_;
+
+  /** LeafのBaseCheckIndex */
+  int i_leaf_index_;
+
+  /** Tail終端記号のIndex */
+  int i_tail_index_;
+};
+
+/** scan用の状態毎の遷移情報 状態0はRoot */
+class DAScanState
+{
+public:
+  /** 失敗時の遷移先 */
+  int i_failure_;
+
+  /** 失敗遷移を辿って最初に見つかる、データの終端となる状態 0 : 無し */
+  int i_output_;
+
+  /** Rootからのバイト長 */
+  int i_depth_;
+};
+
+/** 予測検索の列挙状態 */
+class DAPredictiveParts
+{
+public:
+  /** zero clear */
+  DAPredictiveParts() noexcept : i_prefix_length_(0), i_remain_(0), i_tail_index_(0) {}
+
+  /** init */
+  void init() noexcept {
+    c_key_.clear();
+    i_nodes_.clear();
+    i_prefix_length_ = 0;
+    i_remain_        = 0;
+    i_tail_index_    = 0;
+  }
+
+public:
+  /** 列挙したByte情報 終端記号は含まない */
+  std::vector<char> c_key_;
+
+  /** 走査中のBaseCheckIndexと次に調べるByte 深さはi_prefix_length_からの相対位置 */
+  std::vector<std::pair<int, int>> i_nodes_;
+
+  /** 接頭辞の長さ */
+  uint64_t i_prefix_length_;
+
+  /** 残りの列挙可能数 */
+  uint64_t i_remain_;
+
+  /** 接頭辞がTail内で一致した場合のTail終端Index 0 : 無し */
+  uint64_t i_tail_index_;
+};
+
+/** 共通接頭辞検索の結果 */
+class DAPrefixResult
+{
+public:
+  /** zero clear */
+  DAPrefixResult() noexcept : i_result_(0), i_length_(0) {}
+
+  /** init */
+  DAPrefixResult(const int64_t i_result, const uint64_t i_length) noexcept
+    : i_result_(i_result), i_length_(i_length) {}
+
+public:
+  /** search result */
+  int64_t i_result_;
+
+  /** 一致したバイト長 */
+  uint64_t i_length_;
+};
+
+/** 最長一致で区切ったToken */
+class DAToken
+{
+public:
+  /** zero clear */
+  DAToken() noexcept : i_offset_(0), i_length_(0), i_result_(0) {}
+
+  /** init */
+  DAToken(const uint64_t i_offset, const uint64_t i_length, const int64_t i_result) noexcept
+    : i_offset_(i_offset), i_length_(i_length), i_result_(i_result) {}
+
+public:
+  /** テキスト中の開始位置 */
+  uint64_t i_offset_;
+
+  /** バイト長 */
+  uint64_t i_length_;
+
+  /** search result 未知のByte列はI_SEARCH_NOHIT */
+  int64_t i_result_;
+};
+
+/** 配置の統計と直近の構築の記録 */
+class DAStats
+{
+public:
+  /** zero clear */
+  DAStats() noexcept
+    : i_array_size_(0), i_used_slots_(0), i_unused_slots_(0), d_fill_ratio_(0), i_leaf_count_(0),
+      i_tail_size_(0), i_tail_bytes_(0), i_shared_tail_bytes_(0),
+      i_result_size_(0), i_result_used_(0), d_result_ratio_(0),
+      i_base_check_extends_(0), i_tail_extends_(0), i_build_times_{0} {}
+
+public:
+  /** BaseCheck配列の要素数 */
+  uint64_t i_array_size_;
+
+  /** 使用中の要素数 Rootを含む */
+  uint64_t i_used_slots_;
+
+  /** 空き要素数 */
+  uint64_t i_unused_slots_;
+
+  /** 使用中の要素の割合 */
+  double d_fill_ratio_;
+
+  /** Leaf数 登録データ数と同じ */
+  uint64_t i_leaf_count_;
+
+  /** Tail配列の使用サイズ */
+  uint64_t i_tail_size_;
+
+  /** 各LeafのTail長(終端記号を含む)の合計 */
+  uint64_t i_tail_bytes_;
+
+  /** I_SHARE_TAILで他のLeafと共有して省いたTailバイト数 */
+  uint64_t i_shared_tail_bytes_;
+
+  /** Tail結果配列の要素数 0 : 結果配列を持たない */
+  uint64_t i_result_size_;
+
+  /** Tail結果配列のうち結果が入っている要素数 */
+  uint64_t i_result_used_;
+
+  /** Tail結果配列の使用割合 */
+  double d_result_ratio_;
+
+  /** Leafの深さ(Rootからの遷移数)毎のLeaf数 */
+  std::vector<uint64_t> i_depth_counts_;
+
+  /** 直近の構築からのBaseCheck配列の拡張回数 */
+  uint64_t i_base_check_extends_;
+
+  /** 直近の構築からのTail配列の拡張回数 */
+  uint64_t i_tail_extends_;
+
+  /** 直近の構築の段階毎の時間 nano秒 DoubleArray::I_PHASE_*で引く 並列構築は各Threadの合計 */
+  uint64_t i_build_times_[DoubleArray::I_PHASE_COUNT];
+};
+
+/** searchの検索Counter */
+class DALookupCounters
+{
+public:
+  static constexpr uint64_t I_DEPTH_MAX = 32;  /* 深さ別に数える上限 これ以上は末尾にまとめる */
+
+public:
+  /** zero clear */
+  DALookupCounters() noexcept
+    : i_searches_(0), i_transitions_(0), i_tail_compares_(0), i_misses_(0), i_miss_depths_{0} {}
+
+public:
+  /** 検索回数 */
+  uint64_t i_searches_;
+
+  /** 試したBase/Check遷移数 */
+  uint64_t i_transitions_;
+
+  /** Tailを比較した回数 */
+  uint64_t i_tail_compares_;
+
+  /** 該当無しの回数 */
+  uint64_t i_misses_;
+
+  /** 該当無しが決まったByte位置毎の回数 */
+  uint64_t i_miss_depths_[I_DEPTH_MAX];
+};
+
+/** Binary形式のヘッダ情報 Sectionの位置はヘッダ先頭からのOffset */
+class DAFileHeader
+{
+public:
+  static constexpr int I_SECTION_BASE    = 0;  /* Base配列     */
+  static constexpr int I_SECTION_CHECK   = 1;  /* Check配列    */
+  static constexpr int I_SECTION_TAIL    = 2;  /* Tail文字配列 */
+  static constexpr int I_SECTION_RESULT  = 3;  /* Tail結果配列 */
+  static constexpr int I_SECTION_UNIT    = 4;  /* Unit配列     */
+  static constexpr int I_SECTION_REVERSE = 5;  /* 逆引きIndex  */
+  static constexpr int I_SECTION_RANK    = 6;  /* 結果位置bit  */
+  static constexpr int I_SECTION_PACKED  = 7;  /* 詰めた結果   */
+  static constexpr int I_SECTION_CODE    = 8;  /* Code表       */
+  static constexpr int I_SECTION_MAX     = 16; /* Section数上限 将来の拡張分を含む */
+
+public:
+  /** zero clear */
+  DAFileHeader() noexcept
+    : i_magic_(0), i_version_(0), i_flags_(0),
+      i_array_size_(0), i_tail_size_(0), i_result_size_(0), i_image_size_(0)
+  {
+    memset(i_section_offset_, 0, sizeof(i_section_offset_));
+    memset(i_section_size_,   0, sizeof(i_section_size_));
+  }
+
+public:
+  /** DoubleArray::I_FILE_MAGIC */
+  uint64_t i_magic_;
+
+  /** DoubleArray::I_FILE_VERSION */
+  uint32_t i_version_;
+
+  /** 構築オプション等のFlag */
+  uint32_t i_flags_;
+
+  /** 要素数サイズ */
+  uint64_t i_array_size_;
+
+  /** Tail文字列サイズ */
+  uint64_t i_tail_size_;
+
+  /** Tail結果配列サイズ */
+  uint64_t i_result_size_;
+
+  /** ヘッダを含めた全体のサイズ */
+  uint64_t i_image_size_;
+
+  /** Section開始位置 I_PAGE_SIZE単位 */
+  uint64_t i_section_offset_[I_SECTION_MAX];
+
+  /** Sectionのバイトサイズ 0 : Section無し */
+  uint64_t i_section_size_[I_SECTION_MAX];
+};
+
+/** Trie Node */
+class TrieNode
+{
+public:
+  /** initのみ */
+  TrieNode(unsigned char c_byte) noexcept : c_byte_(c_byte), p_same_layer_(nullptr), p_child_top_(nullptr), node_parts_(nullptr) {}
+
+  /** initのみ */
+  TrieNode(unsigned char c_byte, TrieNode* p_same_layer, TrieNode* p_next, NodeParts* node_parts) noexcept
+    : c_byte_(c_byte), p_same_layer_(p_same_layer), p_child_top_(p_next), node_parts_(node_parts) {}
+
+  /** cost削減のためvirtualは付加しない */
+  ~TrieNode() noexcept {}
+
+  /** move */
+  TrieNode(TrieNode&& trie_node) noexcept
+    : c_byte_(trie_node.c_byte_),
+      p_same_layer_(trie_node.p_same_layer_),
+      p_child_top_(trie_node.p_child_top_),
+      node_parts_(trie_node.node_parts_) {}
+
+  /** = operator */
+  TrieNode& operator = (const TrieNode& trie_node)
+  {
+    c_byte_       = trie_node.c_byte_;
     p_same_layer_ = trie_node.p_same_layer_;
     p_child_top_  = trie_node.p_child_top_;
     node_parts_   = trie_node.node_parts_;
@@ -353,21 +1493,13 @@ class NodeParts
 public:
   NodeParts() : c_tail_(nullptr), i_tail_size_(0), i_result_(0) {}
   NodeParts(
-    char* c_tail,
+    const char* c_tail,
     const uint64_t i_tail_size,
     const int64_t result) : c_tail_(c_tail), i_tail_size_(i_tail_size), i_result_(result) {}
 
-  ~NodeParts() noexcept
-  {
-    if (c_tail_) {
-      delete[] c_tail_;
-      c_tail_ = 0;
-    }
-  }
-
 public:
-  /** Tailに格納可能な場合に使うデータ */
-  char* c_tail_;
+  /** Tailに格納可能な場合に使うデータ 入力データを指すだけで所有しない */
+  const char* c_tail_;
 
   /** Tailのデータサイズ */
   uint64_t i_tail_size_;
@@ -376,81 +1508,305 @@ public:
   int64_t i_result_;
 };
 
-/** DoubleArrayに格納するデータ構造 */
-class ByteArray
+/** DoubleArray構築時のTrieNode, NodePartsの確保先
+* 必要数を先に数えて一括で確保し、先頭から順に切り出す。
+* 個別に解放はせず、Arenaの破棄でまとめて解放する
+*/
+class DABuildArena
 {
 public:
-  ByteArray() : c_byte_(nullptr), i_byte_length_(0), result_(0) {}
-
-  /** コンストラクタ */
-  ByteArray(
-    const char* c_byte,
-    const uint64_t i_byte_length,
-    const int64_t result) : i_byte_length_(i_byte_length), result_(result)
+  /** 確保 切り出す数がこれを超えるとそれまでのPointerが無効になる
+  * @param i_node_count  TrieNode数
+  * @param i_parts_count NodeParts数
+  */
+  void reserve(
+    const uint64_t i_node_count,
+    const uint64_t i_parts_count)
   {
-    c_byte_ = new char[i_byte_length_ + 1]; /* 終端記号分+1 */
-    memcpy(c_byte_, c_byte, i_byte_length_);
-    c_byte_[i_byte_length_] = 0x00; /* 終端記号 */
-    ++i_byte_length_; /* 終端記号まで含めたLengthにする */
+    nodes_.reserve(i_node_count);
+    parts_.reserve(i_parts_count);
   }
 
-  /** copy */
-  ByteArray(const ByteArray& byte_array) : i_byte_length_(byte_array.i_byte_length_), result_(byte_array.result_)
+  /** TrieNodeを切り出す */
+  TrieNode* createNode(
+    const unsigned char c_byte,
+    TrieNode* p_next,
+    NodeParts* node_parts) noexcept
   {
-    if (i_byte_length_) {
-      c_byte_ = new char[i_byte_length_];
-      memcpy(c_byte_, byte_array.c_byte_, i_byte_length_);
-    }
+    nodes_.emplace_back(c_byte, nullptr, p_next, node_parts);
+    return &nodes_.back();
   }
 
-  /** 何もしない */
-  ~ByteArray() {}
-
-  /** move */
-  ByteArray(ByteArray&& byte_array) noexcept
-    : c_byte_(byte_array.c_byte_), i_byte_length_(byte_array.i_byte_length_), result_(byte_array.result_) {}
-
-  /** = operator */
-  ByteArray& operator = (const ByteArray& byte_array)
+  /** NodePartsを切り出す */
+  NodeParts* createParts(
+    const char* c_tail,
+    const uint64_t i_tail_size,
+    const int64_t result) noexcept
   {
-    c_byte_        = byte_array.c_byte_;
-    i_byte_length_ = byte_array.i_byte_length_;
-    result_        = byte_array.result_;
-    return *this;
+    parts_.emplace_back(c_tail, i_tail_size, result);
+    return &parts_.back();
   }
 
-  /** ByteDataを削除 */
-  void deleteByteArray() noexcept
-  {
-    if (c_byte_) {
-      delete[] c_byte_;
-    }
-  }
+public:
+  /** TrieNodeの確保先 */
+  std::vector<TrieNode> nodes_;
 
+  /** NodePartsの確保先 */
+  std::vector<NodeParts> parts_;
+};
+
+/** 逐次構築で確定した子Node */
+class DAStreamChild
+{
 public:
-  /** Byte Data */
-  char* c_byte_;
+  /** init */
+  DAStreamChild(
+    const unsigned char c_label,
+    const int i_base,
+    const uint32_t i_label_begin,
+    const uint32_t i_label_count) noexcept
+    : c_label_(c_label), i_base_(i_base), i_label_begin_(i_label_begin), i_label_count_(i_label_count) {}
 
-  /** Byte Length */
-  uint64_t i_byte_length_;
+public:
+  /** 親からの遷移Byte */
+  unsigned char c_label_;
 
-  /** 検索データが存在した場合の結果 */
-  int64_t result_;
+  /** base値 マイナス値はTailIndex */
+  int i_base_;
+
+  /** 子のLabelの親のc_grand_labels_での開始位置 */
+  uint32_t i_label_begin_;
+
+  /** 子の数 Leafは0 */
+  uint32_t i_label_count_;
 };
 
-/** DoubleArray構築に使用するData */
-class ByteArrays : public std::vector<ByteArray>
+/** 逐次構築で開いているNode 子が確定するまで保持する */
+class DAStreamNode
 {
 public:
-  ByteArrays() {}
-  ~ByteArrays() noexcept
-  {
-    for (auto& data : *this) {
-      data.deleteByteArray();
-    }
+  /** init 確保した領域は再利用する */
+  void init() noexcept {
+    children_.clear();
+    c_grand_labels_.clear();
   }
 
-  /** add Data
+public:
+  /** 確定した子 Byte昇順 */
+  std::vector<DAStreamChild> children_;
+
+  /** 子の子のLabel 子のCheckを設定するのに使用 */
+  std::vector<unsigned char> c_grand_labels_;
+};
+
+/** 並列構築で分岐Byte毎に分けた部分DoubleArray */
+class DASubArray
+{
+public:
+  /** zero clear */
+  DASubArray() noexcept : i_begin_(0), i_end_(0), i_tail_index_(1), i_error_(0), b_single_(false) {}
+
+public:
+  /** 部分DoubleArray */
+  DoubleArray double_array_;
+
+  /** 構築データの開始位置 */
+  uint64_t i_begin_;
+
+  /** 構築データの終了位置 */
+  uint64_t i_end_;
+
+  /** 書き込んだ次のTailIndex */
+  int i_tail_index_;
+
+  /** 構築結果 */
+  int i_error_;
+
+  /** 同一データのみで部分DoubleArrayを構築しない */
+  bool b_single_;
+};
+
+/** DoubleArray構築時の空き要素管理
+* 空き要素を昇順の双方向リストで繋ぎ、Base値の候補を空き要素からのみ探す。
+* リストに繋ぐのは末尾のI_OPEN_BLOCKS個のBlockだけで、それより前の
+* 殆ど埋まったBlockは閉じて候補にしないので、1Nodeの候補数に上限ができる
+*/
+class DAEmptySlots
+{
+public:
+  static constexpr int I_NONE        =  -1; /* 該当要素無し               */
+  static constexpr int I_BLOCK_SIZE  = 256; /* 要素を開閉する単位         */
+  static constexpr int I_OPEN_BLOCKS =   8; /* 候補にするBlock数          */
+
+public:
+  /** init only */
+  DAEmptySlots() noexcept : i_head_(I_NONE), i_tail_(I_NONE), i_size_(0), i_closed_size_(0) {}
+
+  /** Blockを1つ開いて空き要素をリストの末尾に繋ぐ 開いたBlockが多すぎる場合は先頭を閉じる
+  * @param i_check      Check配列 使用済みの要素は繋がない
+  * @param i_array_size Check配列のサイズ
+  */
+  void openBlock(
+    const int* i_check,
+    const uint64_t i_array_size)
+  {
+    const uint64_t i_new_size(i_size_ + I_BLOCK_SIZE);
+    i_nexts_.resize(i_new_size, I_NONE);
+    i_prevs_.resize(i_new_size, I_NONE);
+    b_linked_.resize(i_new_size, false);
+    for (uint64_t i = i_size_; i < i_new_size; ++i) {
+      if ((i < i_array_size) && (i_check[i] != DoubleArray::I_ARRAY_NO_DATA))
+        continue;  /* 既に使用済み */
+
+      b_linked_[i] = true;
+      i_prevs_[i]  = i_tail_;
+      if (i_tail_ == I_NONE) i_head_ = static_cast<int>(i);
+      else                   i_nexts_[i_tail_] = static_cast<int>(i);
+      i_tail_ = static_cast<int>(i);
+    }
+    i_size_ = i_new_size;
+
+    if (i_size_ - i_closed_size_ > I_OPEN_BLOCKS * I_BLOCK_SIZE) {
+      for (uint64_t i = i_closed_size_, i_last = i_closed_size_ + I_BLOCK_SIZE; i < i_last; ++i) {
+        use(static_cast<int>(i));  /* 閉じたBlockの空きは候補にしない */
+      }
+      i_closed_size_ += I_BLOCK_SIZE;
+    }
+  }
+
+  /** 開いている要素数 */
+  uint64_t size() const noexcept { return i_size_; }
+
+  /** 先頭の空き要素 */
+  int front() const noexcept { return i_head_; }
+
+  /** 次の空き要素
+  * @param i_index 基準の要素 リストに繋がっていること
+  */
+  int next(
+    const int i_index) const noexcept
+  {
+    return i_nexts_[i_index];
+  }
+
+  /** 要素を使用済みにしてリストから外す
+  * @param i_index 使用した要素
+  */
+  void use(
+    const int i_index) noexcept
+  {
+    if ((static_cast<uint64_t>(i_index) >= i_size_) || (!b_linked_[i_index]))
+      return;
+
+    b_linked_[i_index] = false;
+    const int i_prev(i_prevs_[i_index]), i_next(i_nexts_[i_index]);
+    if (i_prev == I_NONE) i_head_ = i_next;
+    else                  i_nexts_[i_prev] = i_next;
+    if (i_next == I_NONE) i_tail_ = i_prev;
+    else                  i_prevs_[i_next] = i_prev;
+  }
+
+private:
+  /** 先頭の空き要素 */
+  int i_head_;
+
+  /** 末尾の空き要素 */
+  int i_tail_;
+
+  /** 開いた要素数 */
+  uint64_t i_size_;
+
+  /** 閉じた要素数 */
+  uint64_t i_closed_size_;
+
+  /** 次の空き要素 */
+  std::vector<int> i_nexts_;
+
+  /** 前の空き要素 */
+  std::vector<int> i_prevs_;
+
+  /** リストに繋がっているか */
+  std::vector<bool> b_linked_;
+};
+
+/** DoubleArrayに格納するデータ構造 */
+class ByteArray
+{
+public:
+  ByteArray() : c_byte_(nullptr), i_byte_length_(0), result_(0) {}
+
+  /** コンストラクタ */
+  ByteArray(
+    const char* c_byte,
+    const uint64_t i_byte_length,
+    const int64_t result) : i_byte_length_(i_byte_length), result_(result)
+  {
+    c_byte_ = new char[i_byte_length_ + 1]; /* 終端記号分+1 */
+    memcpy(c_byte_, c_byte, i_byte_length_);
+    c_byte_[i_byte_length_] = 0x00; /* 終端記号 */
+    ++i_byte_length_; /* 終端記号まで含めたLengthにする */
+  }
+
+  /** copy */
+  ByteArray(const ByteArray& byte_array) : i_byte_length_(byte_array.i_byte_length_), result_(byte_array.result_)
+  {
+    if (i_byte_length_) {
+      c_byte_ = new char[i_byte_length_];
+      memcpy(c_byte_, byte_array.c_byte_, i_byte_length_);
+    }
+  }
+
+  /** 何もしない */
+  ~ByteArray() {}
+
+  /** move */
+  ByteArray(ByteArray&& byte_array) noexcept
+    : c_byte_(byte_array.c_byte_), i_byte_length_(byte_array.i_byte_length_), result_(byte_array.result_) {}
+
+  /** = operator */
+  ByteArray& operator = (const ByteArray& byte_array)
+  {
+    c_byte_        = byte_array.c_byte_;
+    i_byte_length_ = byte_array.i_byte_length_;
+    result_        = byte_array.result_;
+    return *this;
+  }
+
+  /** ByteDataを削除 */
+  void deleteByteArray() noexcept
+  {
+    if (c_byte_) {
+      delete[] c_byte_;
+    }
+  }
+
+public:
+  /** Byte Data */
+  char* c_byte_;
+
+  /** Byte Length */
+  uint64_t i_byte_length_;
+
+  /** 検索データが存在した場合の結果 */
+  int64_t result_;
+};
+
+/** DoubleArray構築に使用するData */
+class ByteArrays : public std::vector<ByteArray>
+{
+public:
+  static constexpr uint64_t I_PARALLEL_SORT_MIN = 0x4000; /* 1Threadでsortする最低データ数 */
+
+public:
+  ByteArrays() {}
+  ~ByteArrays() noexcept
+  {
+    for (auto& data : *this) {
+      data.deleteByteArray();
+    }
+  }
+
+  /** add Data
   * @param c_byte   byte data
   * @param i_length byte length
   * @param result   result data
@@ -468,16 +1824,774 @@ public:
   /** sort */
   void sort() noexcept
   {
-    std::sort(begin(), end(), [] (const auto& first, const auto& second) {
-      bool b_second_large(first.i_byte_length_ < second.i_byte_length_);
-      const int64_t i_low_size(b_second_large ? first.i_byte_length_ : second.i_byte_length_);
-      int i_result(memcmp(first.c_byte_, second.c_byte_, i_low_size));
-      if (     i_result < 0)   return true;
-      else if (i_result > 0)   return false;
-      else if (b_second_large) return true;
-      else                     return false;});
+    std::sort(begin(), end(), compare);
+  }
+
+  /** 並列sort 分割して各Threadでsortし、隣同士を併合していく
+  * Threadを起動できない場合は1Threadでsortする
+  * @param i_thread_count Thread数
+  */
+  void sort(
+    const unsigned int i_thread_count) noexcept
+  {
+    const uint64_t i_size(size());
+    const uint64_t i_parts(std::min<uint64_t>(i_thread_count, i_size / I_PARALLEL_SORT_MIN));
+    if (i_parts <= 1) {
+      sort();
+      return;
+    }
+
+    std::vector<uint64_t> i_bounds;
+    std::vector<std::thread> threads;
+    try {
+      for (uint64_t i = 0; i <= i_parts; ++i) {
+        i_bounds.push_back(i_size * i / i_parts);
+      }
+      for (uint64_t i = 0; i < i_parts; ++i) {
+        threads.emplace_back([this, &i_bounds, i] () {
+          std::sort(begin() + i_bounds[i], begin() + i_bounds[i + 1], compare);});
+      }
+      for (auto& sort_thread : threads) {
+        sort_thread.join();
+      }
+      threads.clear();
+
+      for (uint64_t i_width = 1; i_width < i_parts; i_width *= 2) {
+        for (uint64_t i = 0; i + i_width < i_parts; i += i_width * 2) {
+          const uint64_t i_middle(i_bounds[i + i_width]), i_last(i_bounds[std::min(i + i_width * 2, i_parts)]);
+          threads.emplace_back([this, &i_bounds, i, i_middle, i_last] () {
+            std::inplace_merge(begin() + i_bounds[i], begin() + i_middle, begin() + i_last, compare);});
+        }
+        for (auto& merge_thread : threads) {
+          merge_thread.join();
+        }
+        threads.clear();
+      }
+    } catch (...) {
+      for (auto& sort_thread : threads) {
+        if (sort_thread.joinable()) sort_thread.join();
+      }
+      sort();
+    }
+  }
+
+  /** sort順の比較 */
+  static bool compare(
+    const ByteArray& first,
+    const ByteArray& second) noexcept
+  {
+    bool b_second_large(first.i_byte_length_ < second.i_byte_length_);
+    const int64_t i_low_size(b_second_large ? first.i_byte_length_ : second.i_byte_length_);
+    int i_result(memcmp(first.c_byte_, second.c_byte_, i_low_size));
+    if (     i_result < 0)   return true;
+    else if (i_result > 0)   return false;
+    else if (b_second_large) return true;
+    else                     return false;
   }
+
+};
+
+/** Reader数のカウンタ Thread毎に分散してCache Lineの競合を避ける */
+class alignas(64) DAReaderSlot
+{
+public:
+  /** zero clear */
+  DAReaderSlot() noexcept : i_count_{0, 0} {}
+
+public:
+  /** Epochの偶奇毎の参照中Reader数 */
+  std::atomic<uint64_t> i_count_[2];
+};
+
+/**
+ * 稼働中に差し替え可能なDoubleArrayの参照口<br/>
+ * Readerはロック無しでDoubleArrayReaderにより現在のVersionを固定し、<br/>
+ * 新しいDoubleArrayはpublish/loadでatomicに差し替える。<br/>
+ * 旧Versionは参照していたReaderが全て抜けてから解放する
+ */
+class DoubleArrayHandle
+{
+public:
+  static constexpr int I_READER_SLOTS = 64; /* Readerカウンタの分散数 */
+
+public:
+  /** init only */
+  DoubleArrayHandle() noexcept;
+
+  /** 読み込みThreadの終了を待ち、現在のDoubleArrayを解放する
+  * 破棄する時点でDoubleArrayReaderが残っていてはならない
+  */
+  ~DoubleArrayHandle() noexcept;
+
+  DoubleArrayHandle(const DoubleArrayHandle&) = delete;
+  DoubleArrayHandle& operator=(const DoubleArrayHandle&) = delete;
+
+  /** 構築済みのDoubleArrayを公開する
+  * 旧Versionを参照するReaderが抜けるまで待ってから旧Versionを解放する
+  * Readerは待たされない
+  * @param double_array newで確保した構築済みのDoubleArray 所有権を移す
+  * @return I_NO_ERROR : 正常終了 0以外 : 異常終了
+  */
+  int publish(
+    DoubleArray* double_array) noexcept;
+
+  /** writeBinaryで書き込んだファイルを新しいVersionとして読み込んで公開する
+  * 読み込みに失敗した場合は現在のVersionをそのまま残す
+  * @param c_file_path   ファイルパス
+  * @param i_file_offset writeBinaryで書き込みを開始したファイル位置
+  * @param b_mapped      true : openMappedで参照する false : readBinaryで読み込む
+  * @return I_NO_ERROR : 正常終了 0以外 : 異常終了
+  */
+  int load(
+    const char* c_file_path,
+    const uint64_t i_file_offset = 0,
+    const bool b_mapped = false) noexcept;
+
+  /** 別Threadでloadを行う 結果はwaitLoadで受け取る
+  * loadAsync/waitLoadは同じThreadから呼び出すこと
+  * @param c_file_path   ファイルパス
+  * @param i_file_offset writeBinaryで書き込みを開始したファイル位置
+  * @param b_mapped      true : openMappedで参照する false : readBinaryで読み込む
+  * @return true : 読み込み開始  false : 読み込み中 もしくはThreadを起動できない
+  */
+  bool loadAsync(
+    const char* c_file_path,
+    const uint64_t i_file_offset = 0,
+    const bool b_mapped = false) noexcept;
+
+  /** loadAsyncの終了を待つ
+  * @return 最後に行ったloadAsyncの結果
+  */
+  int waitLoad() noexcept;
+
+  /** 公開中のVersion番号を取得する
+  * @return publishした回数
+  */
+  uint64_t getVersion() const noexcept;
+
+private:
+  /** 差し替え前に参照を始めたReaderが全て抜けるまで待つ */
+  void waitReaders() noexcept;
+
+private:
+  friend class DoubleArrayReader;
+
+  /** 公開中のDoubleArray */
+  std::atomic<DoubleArray*> current_;
+
+  /** Readerの登録先を切り替えるEpoch */
+  std::atomic<uint64_t> i_epoch_;
+
+  /** 公開中のVersion番号 */
+  std::atomic<uint64_t> i_version_;
+
+  /** Readerカウンタ */
+  mutable DAReaderSlot slots_[I_READER_SLOTS];
+
+  /** publishの直列化 */
+  std::mutex publish_mutex_;
+
+  /** loadAsyncのThread */
+  std::thread load_thread_;
+
+  /** loadAsyncの実行中フラグ */
+  std::atomic<bool> b_loading_;
+
+  /** loadAsyncの結果 */
+  std::atomic<int> i_load_error_;
 };
 
+/**
+ * DoubleArrayHandleの現在のVersionを固定して参照する<br/>
+ * 生存中は参照したDoubleArrayが解放されない。<br/>
+ * 差し替えを待たせないよう、検索の間だけ生成すること
+ */
+class DoubleArrayReader
+{
+public:
+  /** 現在のVersionを固定する ロックは取らない */
+  explicit DoubleArrayReader(const DoubleArrayHandle& handle) noexcept
+    : slot_(handle.slots_[getSlotIndex()])
+  {
+    i_parity_ = handle.i_epoch_.load() & 1;
+    slot_.i_count_[i_parity_].fetch_add(1);
+    double_array_ = handle.current_.load();
+  }
+
+  /** 固定を解除する */
+  ~DoubleArrayReader() noexcept
+  {
+    slot_.i_count_[i_parity_].fetch_sub(1, std::memory_order_release);
+  }
+
+  DoubleArrayReader(const DoubleArrayReader&) = delete;
+  DoubleArrayReader& operator=(const DoubleArrayReader&) = delete;
+
+  /** 固定したDoubleArray 未公開ならnullptr */
+  const DoubleArray* get() const noexcept { return double_array_; }
+
+  /** 固定したDoubleArray */
+  const DoubleArray* operator->() const noexcept { return double_array_; }
+
+  /** 公開済みかチェック */
+  explicit operator bool() const noexcept { return double_array_ != nullptr; }
+
+private:
+  /** Thread毎のReaderカウンタの位置 */
+  static int getSlotIndex() noexcept
+  {
+    static std::atomic<int> i_next_slot(0);
+    thread_local const int i_slot(i_next_slot.fetch_add(1, std::memory_order_relaxed) % DoubleArrayHandle::I_READER_SLOTS);
+    return i_slot;
+  }
+
+private:
+  /** 登録したReaderカウンタ */
+  DAReaderSlot& slot_;
+
+  /** 登録したEpochの偶奇 */
+  uint64_t i_parity_;
+
+  /** 固定したDoubleArray */
+  const DoubleArray* double_array_;
+};
+
+/** DoubleArrayOverlayの差分1件 */
+class DAOverlayEntry
+{
+public:
+  /** init */
+  DAOverlayEntry(
+    const int64_t result = DoubleArray::I_SEARCH_NOHIT,
+    const bool b_erased = false) noexcept : i_result_(result), b_erased_(b_erased) {}
+
+public:
+  /** 追加・更新後の結果 */
+  int64_t i_result_;
+
+  /** true : 削除済み(tombstone) */
+  bool b_erased_;
+};
+
+/**
+ * 不変のDoubleArrayに小さな差分を重ねて更新を受け付ける辞書<br/>
+ * insert/eraseは差分(削除はtombstone)に記録するだけなので軽く、<br/>
+ * 検索は差分→土台のDoubleArrayの順に調べる。差分に無いByte列はHash bit表で見分け、ロックを取らない。<br/>
+ * compactは差分を凍結して土台と併合したDoubleArrayを作り、DoubleArrayHandleで差し替える。<br/>
+ * 併合中も凍結した差分を検索に使うので、Readerは待たされない
+ */
+class DoubleArrayOverlay
+{
+public:
+  typedef std::map<std::string, DAOverlayEntry, std::less<>> DeltaMap;
+
+  static constexpr uint64_t I_FILTER_WORDS = 1024; /* 差分の有無を調べるbit表の要素数 */
+
+public:
+  /** init only
+  * @param i_option compactで作り直すDoubleArrayの構築オプション
+  */
+  explicit DoubleArrayOverlay(
+    const int i_option = DoubleArray::I_NO_OPTION) noexcept;
+
+  /** compactの終了を待つ */
+  ~DoubleArrayOverlay() noexcept;
+
+  DoubleArrayOverlay(const DoubleArrayOverlay&) = delete;
+  DoubleArrayOverlay& operator=(const DoubleArrayOverlay&) = delete;
+
+  /** 土台のDoubleArrayを差し替える 差分はそのまま重ねる
+  * @param double_array newで確保した構築済みのDoubleArray 所有権を移す
+  * @return I_NO_ERROR : 正常終了 0以外 : 異常終了
+  */
+  int setBase(
+    DoubleArray* double_array) noexcept;
+
+  /** 検索する
+  * @param c_byte        search bytes
+  * @param i_byte_length search data length
+  * @return search result
+  */
+  int64_t search(
+    const char* c_byte,
+    const uint64_t i_byte_length) const noexcept;
+
+  /** データを追加する 既に存在する場合は結果を更新する
+  * @param c_byte        追加するByte列 空は不可
+  * @param i_byte_length 追加するByte長
+  * @param result        検索結果
+  * @return I_NO_ERROR : 正常終了 0以外 : 異常終了
+  */
+  int insert(
+    const char* c_byte,
+    const uint64_t i_byte_length,
+    const int64_t result) noexcept;
+
+  /** データを削除する 存在しなくてもtombstoneを記録する
+  * @param c_byte        削除するByte列
+  * @param i_byte_length 削除するByte長
+  * @return I_NO_ERROR : 正常終了 0以外 : 異常終了
+  */
+  int erase(
+    const char* c_byte,
+    const uint64_t i_byte_length) noexcept;
+
+  /** 差分を土台に併合したDoubleArrayを作って差し替える
+  * 失敗した場合も差分は残るので、検索結果は変わらない
+  * @return I_NO_ERROR : 正常終了 0以外 : 異常終了
+  */
+  int compact() noexcept;
+
+  /** 別Threadでcompactを行う 結果はwaitCompactで受け取る
+  * compactAsync/waitCompactは同じThreadから呼び出すこと
+  * @return true : 併合開始  false : 併合中 もしくはThreadを起動できない
+  */
+  bool compactAsync() noexcept;
+
+  /** compactAsyncの終了を待つ
+  * @return 最後に行ったcompactAsyncの結果
+  */
+  int waitCompact() noexcept;
+
+  /** 差分の件数を取得する 凍結中の分も含む
+  * @return 差分の件数
+  */
+  uint64_t getDeltaSize() const noexcept;
+
+  /** 土台のDoubleArrayの参照口 */
+  const DoubleArrayHandle& getBase() const noexcept { return base_; }
+
+private:
+  /** 差分から検索する
+  * @param result        search result
+  * @param c_byte        search bytes
+  * @param i_byte_length search data length
+  * @return true : 差分に記録がある
+  */
+  bool searchDelta(
+    int64_t& result,
+    const char* c_byte,
+    const uint64_t i_byte_length) const noexcept;
+
+  /** 差分のbit表での位置を求める
+  * @param c_byte        Byte列
+  * @param i_byte_length Byte長
+  * @return bit位置
+  */
+  static uint64_t getFilterBit(
+    const char* c_byte,
+    const uint64_t i_byte_length) noexcept;
+
+  /** 差分を記録する
+  * @param c_byte        Byte列
+  * @param i_byte_length Byte長
+  * @param entry         記録する差分
+  * @return I_NO_ERROR : 正常終了 0以外 : 異常終了
+  */
+  int putDelta(
+    const char* c_byte,
+    const uint64_t i_byte_length,
+    const DAOverlayEntry& entry) noexcept;
+
+  /** 土台と凍結した差分を辞書順に併合したDoubleArrayを作る
+  * @param double_array 土台のDoubleArray nullptrは空
+  * @param merged       作成したDoubleArray
+  * @return I_NO_ERROR : 正常終了 0以外 : 異常終了
+  */
+  int mergeDelta(
+    const DoubleArray* double_array,
+    DoubleArray& merged) const noexcept;
+
+private:
+  /** 土台のDoubleArray */
+  DoubleArrayHandle base_;
+
+  /** insert/eraseを記録する差分 */
+  DeltaMap active_delta_;
+
+  /** compact中の差分 併合が終わるまで検索に使う */
+  DeltaMap frozen_delta_;
+
+  /** 差分の件数 0ならsearchはロックを取らない */
+  std::atomic<uint64_t> i_delta_size_;
+
+  /** 差分に含まれるByte列のHash bit表 bitが立っていなければロックを取らずに土台を調べる */
+  std::atomic<uint64_t> i_delta_filter_[I_FILTER_WORDS];
+
+  /** 差分の保護 */
+  mutable std::shared_mutex delta_mutex_;
+
+  /** compact/setBaseの直列化 */
+  std::mutex compact_mutex_;
+
+  /** compactAsyncのThread */
+  std::thread compact_thread_;
+
+  /** compactAsyncの実行中フラグ */
+  std::atomic<bool> b_compacting_;
+
+  /** compactAsyncの結果 */
+  std::atomic<int> i_compact_error_;
+
+  /** compactで作り直すDoubleArrayの構築オプション */
+  int i_option_;
+};
+
+/** BasicDoubleArrayのBinary形式のヘッダ IndexT/ValueTの幅を記録する */
+class DABasicFileHeader
+{
+public:
+  static constexpr uint64_t I_FILE_MAGIC   = 0x31425252414c4244; /* Binary形式の識別子 "DBLARRB1" */
+  static constexpr uint32_t I_FILE_VERSION = 1;                  /* Binary形式のVersion          */
+
+public:
+  /** zero clear */
+  DABasicFileHeader() noexcept
+    : i_magic_(0), i_version_(0), i_index_width_(0), i_value_width_(0),
+      i_reserved_(0), i_array_size_(0), i_tail_size_(0) {}
+
+public:
+  /** I_FILE_MAGIC */
+  uint64_t i_magic_;
+
+  /** I_FILE_VERSION */
+  uint32_t i_version_;
+
+  /** sizeof(IndexT) */
+  uint32_t i_index_width_;
+
+  /** sizeof(ValueT) */
+  uint32_t i_value_width_;
+
+  /** 未使用 */
+  uint32_t i_reserved_;
+
+  /** 要素数サイズ */
+  uint64_t i_array_size_;
+
+  /** Tail文字列サイズ */
+  uint64_t i_tail_size_;
+};
+
+/**
+ * BasicDoubleArrayのBase/Check<br/>
+ * Baseは符号付きとして扱い、負値はTail位置を表す。空き要素のCheckは全bit 1
+ */
+template<class IndexT>
+class DABasicUnit
+{
+public:
+  /** Base値 */
+  IndexT i_base_;
+
+  /** 親のBaseCheckIndex */
+  IndexT i_check_;
+};
+
+/**
+ * Index幅と結果の型を選べる検索専用のDoubleArray<br/>
+ * 構築済みのDoubleArrayから変換して作る。IndexTはuint16_t/uint32_t/uint64_tで、<br/>
+ * 小さな辞書は狭いIndexにすることで配列のサイズを詰められる。<br/>
+ * 結果はTail終端記号の直後にValueTのまま格納するので、任意のtrivially copyableな型を使える。<br/>
+ * 検索はIndexT毎にcompile時に特殊化される
+ */
+template<class IndexT, class ValueT = int64_t>
+class BasicDoubleArray
+{
+  static_assert(std::is_unsigned<IndexT>::value && (sizeof(IndexT) >= 2), "IndexT must be uint16_t, uint32_t or uint64_t");
+  static_assert(std::is_trivially_copyable<ValueT>::value, "ValueT must be trivially copyable");
+
+public:
+  typedef typename std::make_signed<IndexT>::type SignedIndex;
+
+  /** DoubleArrayの検索結果をValueTに変換する関数 */
+  typedef std::function<ValueT(int64_t result)> ValueFunction;
+
+public:
+  /** init only */
+  BasicDoubleArray() noexcept { clear(); }
+
+  /** 構築済みのDoubleArrayから変換する
+  * 要素数やTailサイズがSignedIndexの範囲に収まらない場合はI_NOT_SUPPORTED
+  * @param double_array 構築済みのDoubleArray
+  * @param get_value    Key毎の検索結果からValueTを求める関数
+  * @return I_NO_ERROR : 正常終了 0以外 : 異常終了
+  */
+  int createDoubleArray(
+    const DoubleArray& double_array,
+    const ValueFunction& get_value) noexcept;
+
+  /** DoubleArrayを構築してから変換する
+  * @param add_datas DoubleArray構築データ
+  * @param get_value ByteArrayの結果からValueTを求める関数
+  * @param i_option  DoubleArrayの構築オプション
+  * @return I_NO_ERROR : 正常終了 0以外 : 異常終了
+  */
+  int createDoubleArray(
+    ByteArrays& add_datas,
+    const ValueFunction& get_value,
+    const int i_option = DoubleArray::I_NO_OPTION) noexcept;
+
+  /** 検索する 引数のバイト列末尾のNULLも使用する
+  * @param value         search result
+  * @param c_byte        search bytes
+  * @param i_byte_length search data length
+  * @return true : 該当有り
+  */
+  bool search(
+    ValueT& value,
+    const char* c_byte,
+    const uint64_t i_byte_length) const noexcept;
+
+  /** DoubleArray情報を書き込む
+  * @param i_write_size 書き込んだデータサイズ
+  * @param fp           OutputFileStream
+  * @return I_NO_ERROR : 正常終了 0以外 : 異常終了
+  */
+  int writeBinary(
+    int64_t& i_write_size,
+    FILE* fp) const noexcept;
+
+  /** DoubleArray情報を読み込む
+  * ヘッダに記録されたIndexT/ValueTの幅が異なる場合はI_NOT_SUPPORTED
+  * @param i_read_size 読み込んだデータサイズ
+  * @param fp          InputFileStream
+  * @return I_NO_ERROR : 正常終了 0以外 : 異常終了
+  */
+  int readBinary(
+    int64_t& i_read_size,
+    FILE* fp) noexcept;
+
+  /** データが作成されているかチェック */
+  bool checkInit() const noexcept { return !units_.empty(); }
+
+  /** 要素数サイズ */
+  uint64_t getArraySize() const noexcept { return units_.size(); }
+
+  /** Tail文字列サイズ */
+  uint64_t getTailSize() const noexcept { return c_tail_.size(); }
+
+  /** 検索に使うメモリのバイトサイズ */
+  uint64_t getMemorySize() const noexcept
+  {
+    return sizeof(units_[0]) * units_.size() + c_tail_.size() + sizeof(c_code_table_);
+  }
+
+  /** 空にする */
+  void clear() noexcept
+  {
+    std::vector<DABasicUnit<IndexT>>().swap(units_);
+    std::vector<char>().swap(c_tail_);
+    for (int i = 0; i < 256; ++i) {
+      c_code_table_[i] = static_cast<unsigned char>(i);
+    }
+  }
+
+private:
+  /** Base/Check配列 */
+  std::vector<DABasicUnit<IndexT>> units_;
+
+  /** Tail文字配列 各Tailは終端記号の直後にValueTを持つ */
+  std::vector<char> c_tail_;
+
+  /** Byte→遷移Codeの表 */
+  unsigned char c_code_table_[256];
+};
+
+
+/* 構築済みのDoubleArrayから変換する                     */
+/* 配置はそのままでBase/Checkの幅だけを変え、            */
+/* TailはLeaf毎に詰め直して終端記号の後に結果を付ける    */
+/* @param double_array 構築済みのDoubleArray             */
+/* @param get_value    Key毎の検索結果からValueTを求める */
+/* @return Error Code                                    */
+template<class IndexT, class ValueT>
+int BasicDoubleArray<IndexT, ValueT>::createDoubleArray(
+  const DoubleArray& double_array,
+  const ValueFunction& get_value) noexcept
+{
+  clear();
+  if (!double_array.checkInit())
+    return DoubleArray::I_NO_ERROR;
+
+  const uint64_t i_max_index(static_cast<uint64_t>(std::numeric_limits<SignedIndex>::max()));
+  const uint64_t i_array_size(double_array.i_array_size_);
+  if (i_array_size > i_max_index)
+    return DoubleArray::I_NOT_SUPPORTED;
+
+  try {
+    units_.resize(i_array_size);
+    c_tail_.push_back(DoubleArray::C_TAIL_CHAR); /* Tail位置0は負値にできないので使わない */
+    for (uint64_t i = 0; i < i_array_size; ++i) {
+      const int i_base (double_array.units_ ? double_array.units_[i].i_base_  : double_array.i_base_[i]);
+      const int i_check(double_array.units_ ? double_array.units_[i].i_check_ : double_array.i_check_[i]);
+      DABasicUnit<IndexT>& unit = units_[i];
+      unit.i_check_ = static_cast<IndexT>(static_cast<SignedIndex>(i_check));
+      if ((i_check == DoubleArray::I_ARRAY_NO_DATA) && (i != 0)) {
+        unit.i_base_ = 0;
+      } else if (i_base >= 0) {
+        unit.i_base_ = static_cast<IndexT>(i_base);
+      } else {
+        const char* c_tail = &double_array.c_tail_[-static_cast<int64_t>(i_base)];
+        const uint64_t i_tail_length(strlen(c_tail));
+        const ValueT value(get_value(double_array.getTailResult(c_tail - double_array.c_tail_ + i_tail_length)));
+        if (c_tail_.size() > i_max_index)
+          return DoubleArray::I_NOT_SUPPORTED;
+
+        unit.i_base_ = static_cast<IndexT>(-static_cast<SignedIndex>(c_tail_.size()));
+        c_tail_.insert(c_tail_.end(), c_tail, c_tail + i_tail_length + 1);
+        c_tail_.insert(c_tail_.end(), reinterpret_cast<const char*>(&value), reinterpret_cast<const char*>(&value) + sizeof(value));
+      }
+    }
+  } catch (...) {
+    clear();
+    return DoubleArray::I_FAILED_MEMORY;
+  }
+
+  memcpy(c_code_table_, double_array.c_code_table_, sizeof(c_code_table_));
+
+  return DoubleArray::I_NO_ERROR;
+}
+
+
+/* DoubleArrayを構築してから変換する                  */
+/* @param add_datas DoubleArray構築データ             */
+/* @param get_value ByteArrayの結果からValueTを求める */
+/* @param i_option  DoubleArrayの構築オプション       */
+/* @return Error Code                                 */
+template<class IndexT, class ValueT>
+int BasicDoubleArray<IndexT, ValueT>::createDoubleArray(
+  ByteArrays& add_datas,
+  const ValueFunction& get_value,
+  const int i_option) noexcept
+{
+  DoubleArray double_array;
+  const int i_error(double_array.createDoubleArray(add_datas, i_option));
+  if (i_error) {
+    clear();
+    return i_error;
+  }
+
+  return createDoubleArray(double_array, get_value);
+}
+
+
+/* 検索する                                */
+/* @param value         search result      */
+/* @param c_byte        search bytes       */
+/* @param i_byte_length search data length */
+/* @return true : 該当有り                 */
+template<class IndexT, class ValueT>
+bool BasicDoubleArray<IndexT, ValueT>::search(
+  ValueT& value,
+  const char* c_byte,
+  const uint64_t i_byte_length) const noexcept
+{
+  if (units_.empty())
+    return false;
+
+  const DABasicUnit<IndexT>* units = units_.data();
+  uint64_t i(0), i_base_index(0);
+  SignedIndex i_base_value(static_cast<SignedIndex>(units[0].i_base_));
+  for (; i <= i_byte_length; ++i) { /* 終端記号の分があるので<=とする */
+    const uint64_t i_check_index(static_cast<uint64_t>(i_base_value) + c_code_table_[static_cast<unsigned char>(c_byte[i])]);
+    const DABasicUnit<IndexT>& unit = units[i_check_index];
+    if (unit.i_check_ != i_base_index) {
+      return false;  /* データが存在しない */
+    }
+
+    i_base_value = static_cast<SignedIndex>(unit.i_base_);
+    if (i_base_value < 0) {
+      break;
+    }
+    i_base_index = i_check_index;
+  }
+
+  /* Tail処理 Tail突入契機のマイナス値をプラスに変換 */
+  uint64_t i_tail_index(static_cast<uint64_t>(-static_cast<int64_t>(i_base_value)));
+  if (i < i_byte_length) {
+    ++i;
+    const uint64_t i_compare_length(i_byte_length - i);
+    if (memcmp(&c_tail_[i_tail_index], &c_byte[i], i_compare_length + 1) != 0)
+      return false;
+
+    i_tail_index += i_compare_length;
+  } else if (i > i_byte_length) {
+    return false;
+  }
+
+  memcpy(&value, &c_tail_[i_tail_index + 1], sizeof(value));
+
+  return true;
+}
+
+
+/* DoubleArray情報を書き込む                  */
+/* @param i_write_size 書き込んだデータサイズ */
+/* @param fp           OutputFileStream       */
+/* @return Error Code                         */
+template<class IndexT, class ValueT>
+int BasicDoubleArray<IndexT, ValueT>::writeBinary(
+  int64_t& i_write_size,
+  FILE* fp) const noexcept
+{
+  DABasicFileHeader header;
+  header.i_magic_       = DABasicFileHeader::I_FILE_MAGIC;
+  header.i_version_     = DABasicFileHeader::I_FILE_VERSION;
+  header.i_index_width_ = sizeof(IndexT);
+  header.i_value_width_ = sizeof(ValueT);
+  header.i_array_size_  = units_.size();
+  header.i_tail_size_   = c_tail_.size();
+
+  if ((1 != fwrite(&header, sizeof(header), 1, fp))
+  ||  (1 != fwrite(c_code_table_, sizeof(c_code_table_), 1, fp))
+  ||  ((header.i_array_size_) && (header.i_array_size_ != fwrite(units_.data(), sizeof(units_[0]), header.i_array_size_, fp)))
+  ||  ((header.i_tail_size_)  && (header.i_tail_size_  != fwrite(c_tail_.data(), sizeof(c_tail_[0]), header.i_tail_size_, fp))))
+    return DoubleArray::I_FAIELD_FILE_IO;
+
+  i_write_size += sizeof(header) + sizeof(c_code_table_) + sizeof(units_[0]) * header.i_array_size_ + header.i_tail_size_;
+
+  return DoubleArray::I_NO_ERROR;
+}
+
+
+/* DoubleArray情報を読み込む                 */
+/* @param i_read_size 読み込んだデータサイズ */
+/* @param fp          InputFileStream        */
+/* @return Error Code                        */
+template<class IndexT, class ValueT>
+int BasicDoubleArray<IndexT, ValueT>::readBinary(
+  int64_t& i_read_size,
+  FILE* fp) noexcept
+{
+  clear();
+  DABasicFileHeader header;
+  if ((1 != fread(&header, sizeof(header), 1, fp))
+  ||  (header.i_magic_ != DABasicFileHeader::I_FILE_MAGIC)
+  ||  (header.i_version_ > DABasicFileHeader::I_FILE_VERSION))
+    return DoubleArray::I_FAIELD_FILE_IO;
+
+  if ((header.i_index_width_ != sizeof(IndexT)) || (header.i_value_width_ != sizeof(ValueT)))
+    return DoubleArray::I_NOT_SUPPORTED;
+
+  try {
+    units_.resize(header.i_array_size_);
+    c_tail_.resize(header.i_tail_size_);
+  } catch (...) {
+    clear();
+    return DoubleArray::I_FAILED_MEMORY;
+  }
+
+  if ((1 != fread(c_code_table_, sizeof(c_code_table_), 1, fp))
+  ||  ((header.i_array_size_) && (header.i_array_size_ != fread(units_.data(), sizeof(units_[0]), header.i_array_size_, fp)))
+  ||  ((header.i_tail_size_)  && (header.i_tail_size_  != fread(c_tail_.data(), sizeof(c_tail_[0]), header.i_tail_size_, fp)))) {
+    clear();
+    return DoubleArray::I_FAIELD_FILE_IO;
+  }
+
+  i_read_size += sizeof(header) + sizeof(c_code_table_) + sizeof(units_[0]) * header.i_array_size_ + header.i_tail_size_;
+
+  return DoubleArray::I_NO_ERROR;
+}
+
 #endif
-  
@@ -0,0 +1,613 @@
+#include "LoudsTrie.h"
+#include <deque>
+
+using namespace std;
+
+
+/* 空にする */
+void DABitVector::clear() noexcept
+{
+  vector<uint64_t>().swap(i_words_);
+  vector<uint64_t>().swap(i_ranks_);
+  vector<uint64_t>().swap(i_select_samples_);
+  i_size_ = 0;
+}
+
+
+/* 追加し終えたらrank/selectの索引を作る                */
+/* Block毎の累積1の数と、I_SELECT_SAMPLE個毎の0の位置の */
+/* Block番号を記録する                                  */
+void DABitVector::build()
+{
+  const uint64_t i_block_count((i_words_.size() + I_BLOCK_WORDS - 1) / I_BLOCK_WORDS);
+  i_ranks_.assign(i_block_count + 1, 0);
+  i_select_samples_.clear();
+
+  uint64_t i_ones(0);
+  for (uint64_t i_block = 0; i_block < i_block_count; ++i_block) {
+    i_ranks_[i_block] = i_ones;
+    const uint64_t i_word_end(min<uint64_t>((i_block + 1) * I_BLOCK_WORDS, i_words_.size()));
+    for (uint64_t i = i_block * I_BLOCK_WORDS; i < i_word_end; ++i) {
+      i_ones += __builtin_popcountll(i_words_[i]);
+    }
+    const uint64_t i_zeros_after(min((i_block + 1) * I_BLOCK_BITS, i_size_) - i_ones);
+    while (i_select_samples_.size() * I_SELECT_SAMPLE < i_zeros_after) {
+      i_select_samples_.push_back(i_block);  /* この0はこのBlockにある */
+    }
+  }
+  i_ranks_[i_block_count] = i_ones;
+  i_select_samples_.push_back(i_block_count);  /* 番兵 */
+}
+
+
+/* [0, i_position)の1の数を求める */
+/* @param i_position 位置         */
+/* @return 1の数                  */
+uint64_t DABitVector::rank1(
+  const uint64_t i_position) const noexcept
+{
+  const uint64_t i_block(i_position / I_BLOCK_BITS);
+  uint64_t i_rank(i_ranks_[i_block]);
+  for (uint64_t i = i_block * I_BLOCK_WORDS; i < i_position / 64; ++i) {
+    i_rank += __builtin_popcountll(i_words_[i]);
+  }
+  if (i_position % 64)
+    i_rank += __builtin_popcountll(i_words_[i_position / 64] & ((1ULL << (i_position % 64)) - 1));
+
+  return i_rank;
+}
+
+
+/* i_count番目(0始まり)の0の位置を求める             */
+/* 標本でBlockの範囲を絞って二分探索し、Block内は    */
+/* word毎の0の数で進めてから、word内を半分ずつ調べる */
+/* @param i_count 0の順位                            */
+/* @return 位置                                      */
+uint64_t DABitVector::select0(
+  const uint64_t i_count) const noexcept
+{
+  uint64_t i_low(i_select_samples_[i_count / I_SELECT_SAMPLE]);
+  uint64_t i_high(i_select_samples_[i_count / I_SELECT_SAMPLE + 1] + 1);
+  i_high = min<uint64_t>(i_high, i_ranks_.size() - 1);
+  while (i_low + 1 < i_high) {  /* i_count番目の0を含む最後のBlock */
+    const uint64_t i_middle((i_low + i_high) / 2);
+    if (i_middle * I_BLOCK_BITS - i_ranks_[i_middle] <= i_count)
+      i_low = i_middle;
+    else
+      i_high = i_middle;
+  }
+
+  uint64_t i_remain(i_count - (i_low * I_BLOCK_BITS - i_ranks_[i_low]));
+  uint64_t i_word_index(i_low * I_BLOCK_WORDS);
+  uint64_t i_zeros(64 - __builtin_popcountll(i_words_[i_word_index]));
+  while (i_zeros <= i_remain) {
+    i_remain -= i_zeros;
+    i_zeros = 64 - __builtin_popcountll(i_words_[++i_word_index]);
+  }
+
+  uint64_t i_word(~i_words_[i_word_index]), i_position(i_word_index * 64);
+  for (uint64_t i_width = 32; i_width >= 1; i_width /= 2) {
+    const uint64_t i_lower(__builtin_popcountll(i_word & ((1ULL << i_width) - 1)));
+    if (i_lower <= i_remain) {
+      i_remain   -= i_lower;
+      i_word    >>= i_width;
+      i_position += i_width;
+    }
+  }
+
+  return i_position;
+}
+
+
+/* i_position以降で最初の0の位置を求める */
+/* @param i_position 位置                */
+/* @return 位置                          */
+uint64_t DABitVector::findNext0(
+  uint64_t i_position) const noexcept
+{
+  uint64_t i_word_index(i_position / 64);
+  uint64_t i_word(~i_words_[i_word_index] >> (i_position % 64));
+  if (i_word)
+    return i_position + __builtin_ctzll(i_word);
+
+  while ((i_word = ~i_words_[++i_word_index]) == 0) {}
+
+  return i_word_index * 64 + __builtin_ctzll(i_word);
+}
+
+
+/* ファイルに書き込む                         */
+/* @param i_write_size 書き込んだデータサイズ */
+/* @param fp           OutputFileStream       */
+/* @return Error Code                         */
+int DABitVector::writeBinary(
+  int64_t& i_write_size,
+  FILE* fp) const noexcept
+{
+  const uint64_t i_word_count(i_words_.size());
+  if ((1 != fwrite(&i_size_, sizeof(i_size_), 1, fp))
+  ||  ((i_word_count) && (i_word_count != fwrite(i_words_.data(), sizeof(i_words_[0]), i_word_count, fp))))
+    return DoubleArray::I_FAIELD_FILE_IO;
+
+  i_write_size += sizeof(i_size_) + sizeof(i_words_[0]) * i_word_count;
+
+  return DoubleArray::I_NO_ERROR;
+}
+
+
+/* ファイルから読み込む 索引は作り直す       */
+/* @param i_read_size 読み込んだデータサイズ */
+/* @param fp          InputFileStream        */
+/* @return Error Code                        */
+int DABitVector::readBinary(
+  int64_t& i_read_size,
+  FILE* fp) noexcept
+{
+  clear();
+  try {
+    uint64_t i_size(0);
+    if (1 != fread(&i_size, sizeof(i_size), 1, fp))
+      return DoubleArray::I_FAIELD_FILE_IO;
+
+    const uint64_t i_word_count((i_size + 63) / 64);
+    i_words_.resize(i_word_count);
+    if ((i_word_count) && (i_word_count != fread(i_words_.data(), sizeof(i_words_[0]), i_word_count, fp))) {
+      clear();
+      return DoubleArray::I_FAIELD_FILE_IO;
+    }
+    i_size_ = i_size;
+    build();
+    i_read_size += sizeof(i_size) + sizeof(i_words_[0]) * i_word_count;
+  } catch (...) {
+    clear();
+    return DoubleArray::I_FAILED_MEMORY;
+  }
+
+  return DoubleArray::I_NO_ERROR;
+}
+
+
+/* 空にする */
+void DAPackedArray::clear() noexcept
+{
+  vector<uint64_t>().swap(i_words_);
+  i_min_  = 0;
+  i_bits_ = 0;
+  i_size_ = 0;
+}
+
+
+/* 値を詰めて設定する                      */
+/* 最小値との差が収まるbit幅を求めて並べる */
+/* @param values 設定する値                */
+void DAPackedArray::assign(
+  const vector<int64_t>& values)
+{
+  clear();
+  if (values.empty())
+    return;
+
+  const auto range = minmax_element(values.begin(), values.end());
+  const uint64_t i_span(static_cast<uint64_t>(*range.second) - static_cast<uint64_t>(*range.first));
+  i_min_  = *range.first;
+  i_bits_ = (i_span ? 64 - __builtin_clzll(i_span) : 0);
+  i_size_ = values.size();
+  i_words_.assign((i_size_ * i_bits_ + 63) / 64 + 1, 0);
+  if (i_bits_ == 0)
+    return;
+
+  for (uint64_t i = 0; i < i_size_; ++i) {
+    const uint64_t i_value(static_cast<uint64_t>(values[i]) - static_cast<uint64_t>(i_min_));
+    const uint64_t i_bit(i * i_bits_);
+    i_words_[i_bit / 64] |= i_value << (i_bit % 64);
+    if ((i_bit % 64) + i_bits_ > 64)
+      i_words_[i_bit / 64 + 1] |= i_value >> (64 - (i_bit % 64));
+  }
+}
+
+
+/* ファイルに書き込む                         */
+/* @param i_write_size 書き込んだデータサイズ */
+/* @param fp           OutputFileStream       */
+/* @return Error Code                         */
+int DAPackedArray::writeBinary(
+  int64_t& i_write_size,
+  FILE* fp) const noexcept
+{
+  const uint64_t i_word_count(i_words_.size());
+  if ((1 != fwrite(&i_min_,       sizeof(i_min_),       1, fp))
+  ||  (1 != fwrite(&i_bits_,      sizeof(i_bits_),      1, fp))
+  ||  (1 != fwrite(&i_size_,      sizeof(i_size_),      1, fp))
+  ||  (1 != fwrite(&i_word_count, sizeof(i_word_count), 1, fp))
+  ||  ((i_word_count) && (i_word_count != fwrite(i_words_.data(), sizeof(i_words_[0]), i_word_count, fp))))
+    return DoubleArray::I_FAIELD_FILE_IO;
+
+  i_write_size += sizeof(i_min_) + sizeof(i_bits_) + sizeof(i_size_) + sizeof(i_word_count) + sizeof(i_words_[0]) * i_word_count;
+
+  return DoubleArray::I_NO_ERROR;
+}
+
+
+/* ファイルから読み込む                      */
+/* @param i_read_size 読み込んだデータサイズ */
+/* @param fp          InputFileStream        */
+/* @return Error Code                        */
+int DAPackedArray::readBinary(
+  int64_t& i_read_size,
+  FILE* fp) noexcept
+{
+  clear();
+  uint64_t i_word_count(0);
+  if ((1 != fread(&i_min_,       sizeof(i_min_),       1, fp))
+  ||  (1 != fread(&i_bits_,      sizeof(i_bits_),      1, fp))
+  ||  (1 != fread(&i_size_,      sizeof(i_size_),      1, fp))
+  ||  (1 != fread(&i_word_count, sizeof(i_word_count), 1, fp))
+  ||  (i_bits_ > 64)
+  ||  (i_word_count < (i_size_ * i_bits_ + 63) / 64 + (i_size_ ? 1 : 0))) {
+    clear();
+    return DoubleArray::I_FAIELD_FILE_IO;
+  }
+
+  try {
+    i_words_.resize(i_word_count);
+  } catch (...) {
+    clear();
+    return DoubleArray::I_FAILED_MEMORY;
+  }
+  if ((i_word_count) && (i_word_count != fread(i_words_.data(), sizeof(i_words_[0]), i_word_count, fp))) {
+    clear();
+    return DoubleArray::I_FAIELD_FILE_IO;
+  }
+
+  i_read_size += sizeof(i_min_) + sizeof(i_bits_) + sizeof(i_size_) + sizeof(i_word_count) + sizeof(i_words_[0]) * i_word_count;
+
+  return DoubleArray::I_NO_ERROR;
+}
+
+
+/* 構築済みのDoubleArrayから変換する                */
+/* 予測検索で全データを辞書順に列挙してから配置する */
+/* @param double_array 構築済みのDoubleArray        */
+/* @return Error Code                               */
+int LoudsTrie::createLoudsTrie(
+  const DoubleArray& double_array) noexcept
+{
+  clear();
+  try {
+    vector<string> keys;
+    vector<int64_t> results;
+    DAPredictiveParts predictive_parts;
+    int64_t result(DoubleArray::I_SEARCH_NOHIT);
+    if ((double_array.checkInit()) && (double_array.predictiveSearch(predictive_parts, "", 0))) {
+      while (double_array.predictiveNext(predictive_parts, result)) {
+        keys.emplace_back(predictive_parts.c_key_.begin(), predictive_parts.c_key_.end());
+        results.push_back(result);
+      }
+    }
+    createLouds(keys, results);
+  } catch (...) {
+    clear();
+    return DoubleArray::I_FAILED_MEMORY;
+  }
+
+  return DoubleArray::I_NO_ERROR;
+}
+
+
+/* 構築データから作成する                      */
+/* DoubleArrayを一旦構築してから変換するので、 */
+/* 同一データの扱いや検索結果は構築時と同じ    */
+/* @param add_datas 構築データ                 */
+/* @return Error Code                          */
+int LoudsTrie::createLoudsTrie(
+  ByteArrays& add_datas) noexcept
+{
+  DoubleArray double_array;
+  const int i_error(double_array.createDoubleArray(add_datas));
+  if (i_error) {
+    clear();
+    return i_error;
+  }
+
+  return createLoudsTrie(double_array);
+}
+
+
+/* 検索する                                */
+/* @param c_byte        search bytes       */
+/* @param i_byte_length search data length */
+/* @return search result                   */
+int64_t LoudsTrie::search(
+  const char* c_byte,
+  const uint64_t i_byte_length) const noexcept
+{
+  if (!checkInit())
+    return DoubleArray::I_SEARCH_NOHIT;
+
+  uint64_t i_node(0);
+  for (uint64_t i = 0; ; ++i) {
+    if (tails_.get(i_node)) {  /* 残りはTailと全て一致する必要がある */
+      if (matchTail(i_node, &c_byte[i], i_byte_length - i) != static_cast<int64_t>(i_byte_length - i))
+        return DoubleArray::I_SEARCH_NOHIT;
+      break;
+    }
+
+    if (i >= i_byte_length)
+      break;
+
+    if ((i_node = getChild(i_node, c_byte[i])) == 0)
+      return DoubleArray::I_SEARCH_NOHIT;  /* データが存在しない */
+  }
+
+  return (terminals_.get(i_node) ? results_.get(terminals_.rank1(i_node)) : DoubleArray::I_SEARCH_NOHIT);
+}
+
+
+/* 共通接頭辞検索                                        */
+/* @param c_byte        search bytes                     */
+/* @param i_byte_length search data length               */
+/* @param results       一致したデータの検索結果と一致長 */
+/* @param i_max_results resultsに格納する最大数          */
+/* @return 一致したデータ数                              */
+uint64_t LoudsTrie::commonPrefixSearch(
+  const char* c_byte,
+  const uint64_t i_byte_length,
+  DAPrefixResult* results,
+  const uint64_t i_max_results) const noexcept
+{
+  if (!checkInit())
+    return 0;
+
+  uint64_t i_count(0), i_node(0);
+  auto addResult = [&](const uint64_t i_length) {
+    if (i_count < i_max_results) {
+      results[i_count] = DAPrefixResult(results_.get(terminals_.rank1(i_node)), i_length);
+    }
+    ++i_count;
+  };
+
+  for (uint64_t i = 0; ; ++i) {
+    if (tails_.get(i_node)) {  /* Tail以降は1データのみなので全て一致すれば終了 */
+      const int64_t i_tail_length(matchTail(i_node, &c_byte[i], i_byte_length - i));
+      if (i_tail_length >= 0)
+        addResult(i + i_tail_length);
+      break;
+    }
+
+    if (terminals_.get(i_node))  /* ここまでが登録データ */
+      addResult(i);
+
+    if ((i >= i_byte_length) || ((i_node = getChild(i_node, c_byte[i])) == 0))
+      break;
+  }
+
+  return i_count;
+}
+
+
+/* LoudsTrie情報を書き込む                    */
+/* @param i_write_size 書き込んだデータサイズ */
+/* @param fp           OutputFileStream       */
+/* @return Error Code                         */
+int LoudsTrie::writeBinary(
+  int64_t& i_write_size,
+  FILE* fp) const noexcept
+{
+  const uint64_t i_magic(I_FILE_MAGIC);
+  const uint32_t i_version(I_FILE_VERSION);
+  const uint64_t i_label_count(c_labels_.size()), i_tail_size(c_tail_.size());
+  if ((1 != fwrite(&i_magic,       sizeof(i_magic),       1, fp))
+  ||  (1 != fwrite(&i_version,     sizeof(i_version),     1, fp))
+  ||  (1 != fwrite(&i_label_count, sizeof(i_label_count), 1, fp))
+  ||  (1 != fwrite(&i_tail_size,   sizeof(i_tail_size),   1, fp))
+  ||  ((i_label_count) && (i_label_count != fwrite(c_labels_.data(), sizeof(c_labels_[0]), i_label_count, fp)))
+  ||  ((i_tail_size)   && (i_tail_size   != fwrite(c_tail_.data(),   sizeof(c_tail_[0]),   i_tail_size,   fp))))
+    return DoubleArray::I_FAIELD_FILE_IO;
+
+  i_write_size += sizeof(i_magic) + sizeof(i_version) + sizeof(i_label_count) + sizeof(i_tail_size)
+                + sizeof(c_labels_[0]) * i_label_count + sizeof(c_tail_[0]) * i_tail_size;
+
+  int i_error(DoubleArray::I_NO_ERROR);
+  if (((i_error = louds_.writeBinary(i_write_size, fp)))
+  ||  ((i_error = terminals_.writeBinary(i_write_size, fp)))
+  ||  ((i_error = tails_.writeBinary(i_write_size, fp)))
+  ||  ((i_error = results_.writeBinary(i_write_size, fp))))
+    return i_error;
+
+  return tail_offsets_.writeBinary(i_write_size, fp);
+}
+
+
+/* LoudsTrie情報を読み込む                   */
+/* @param i_read_size 読み込んだデータサイズ */
+/* @param fp          InputFileStream        */
+/* @return Error Code                        */
+int LoudsTrie::readBinary(
+  int64_t& i_read_size,
+  FILE* fp) noexcept
+{
+  clear();
+  uint64_t i_magic(0), i_label_count(0), i_tail_size(0);
+  uint32_t i_version(0);
+  if ((1 != fread(&i_magic,       sizeof(i_magic),       1, fp))
+  ||  (i_magic != I_FILE_MAGIC)
+  ||  (1 != fread(&i_version,     sizeof(i_version),     1, fp))
+  ||  (i_version > I_FILE_VERSION)
+  ||  (1 != fread(&i_label_count, sizeof(i_label_count), 1, fp))
+  ||  (1 != fread(&i_tail_size,   sizeof(i_tail_size),   1, fp)))
+    return DoubleArray::I_FAIELD_FILE_IO;
+
+  try {
+    c_labels_.resize(i_label_count);
+    c_tail_.resize(i_tail_size);
+  } catch (...) {
+    clear();
+    return DoubleArray::I_FAILED_MEMORY;
+  }
+
+  if (((i_label_count) && (i_label_count != fread(c_labels_.data(), sizeof(c_labels_[0]), i_label_count, fp)))
+  ||  ((i_tail_size)   && (i_tail_size   != fread(c_tail_.data(),   sizeof(c_tail_[0]),   i_tail_size,   fp)))) {
+    clear();
+    return DoubleArray::I_FAIELD_FILE_IO;
+  }
+  i_read_size += sizeof(i_magic) + sizeof(i_version) + sizeof(i_label_count) + sizeof(i_tail_size)
+               + sizeof(c_labels_[0]) * i_label_count + sizeof(c_tail_[0]) * i_tail_size;
+
+  int i_error(DoubleArray::I_NO_ERROR);
+  if (((i_error = louds_.readBinary(i_read_size, fp)))
+  ||  ((i_error = terminals_.readBinary(i_read_size, fp)))
+  ||  ((i_error = tails_.readBinary(i_read_size, fp)))
+  ||  ((i_error = results_.readBinary(i_read_size, fp)))
+  ||  ((i_error = tail_offsets_.readBinary(i_read_size, fp)))) {
+    clear();
+    return i_error;
+  }
+
+  return DoubleArray::I_NO_ERROR;
+}
+
+
+/* 検索に使うメモリのバイトサイズ */
+/* @return バイトサイズ           */
+uint64_t LoudsTrie::getMemorySize() const noexcept
+{
+  return louds_.getMemorySize() + terminals_.getMemorySize() + tails_.getMemorySize()
+       + sizeof(c_labels_[0]) * c_labels_.size() + results_.getMemorySize()
+       + sizeof(c_tail_[0]) * c_tail_.size() + tail_offsets_.getMemorySize();
+}
+
+
+/* 空にする */
+void LoudsTrie::clear() noexcept
+{
+  louds_.clear();
+  terminals_.clear();
+  tails_.clear();
+  vector<char>().swap(c_labels_);
+  results_.clear();
+  vector<char>().swap(c_tail_);
+  tail_offsets_.clear();
+}
+
+
+/* 辞書順に並んだ一意のデータから幅優先でNodeを配置する  */
+/* 同じ接頭辞を持つデータの範囲をNodeとしてQueueに積み、 */
+/* 取り出す毎に次のByte毎の子の範囲に分ける。            */
+/* 1データだけの範囲で続きがある場合は、続きをTailにする */
+/* @param keys    データ                                 */
+/* @param results 検索結果                               */
+void LoudsTrie::createLouds(
+  const vector<string>& keys,
+  const vector<int64_t>& results)
+{
+  struct LoudsRange {
+    uint64_t i_begin_;  /* 先頭データ     */
+    uint64_t i_end_;    /* 末尾データの次 */
+  };
+
+  deque<LoudsRange> queue;
+  queue.push_back({0, keys.size()});
+  louds_.push(true);   /* 仮想Root "10" */
+  louds_.push(false);
+  c_labels_.push_back(DoubleArray::C_TAIL_CHAR);  /* RootのLabelは使わない */
+
+  vector<int64_t> node_results, tail_offsets;
+  uint64_t i_depth(0), i_level_remain(1), i_next_level(0);
+  while (!queue.empty()) {
+    if (i_level_remain == 0) {  /* 次の深さのNodeに移った */
+      ++i_depth;
+      i_level_remain = i_next_level;
+      i_next_level   = 0;
+    }
+
+    uint64_t i_begin(queue.front().i_begin_);
+    const uint64_t i_end(queue.front().i_end_);
+    queue.pop_front();
+    --i_level_remain;
+
+    const bool b_tail((i_begin + 1 == i_end) && (keys[i_begin].size() > i_depth));
+    tails_.push(b_tail);
+    if (b_tail) {  /* 続きは1データだけなのでTailにする */
+      terminals_.push(true);
+      node_results.push_back(results[i_begin]);
+      tail_offsets.push_back(static_cast<int64_t>(c_tail_.size()));
+      c_tail_.insert(c_tail_.end(), keys[i_begin].begin() + i_depth, keys[i_begin].end());
+      c_tail_.push_back(DoubleArray::C_TAIL_CHAR);
+      louds_.push(false);
+      continue;
+    }
+
+    const bool b_terminal((i_begin < i_end) && (keys[i_begin].size() == i_depth));
+    terminals_.push(b_terminal);
+    if (b_terminal) {  /* 辞書順なので終端するデータは先頭にある */
+      node_results.push_back(results[i_begin]);
+      ++i_begin;
+    }
+
+    while (i_begin < i_end) {
+      const char c_label(keys[i_begin][i_depth]);
+      uint64_t i_child_end(i_begin + 1);
+      while ((i_child_end < i_end) && (keys[i_child_end][i_depth] == c_label)) {
+        ++i_child_end;
+      }
+      louds_.push(true);
+      c_labels_.push_back(c_label);
+      queue.push_back({i_begin, i_child_end});
+      ++i_next_level;
+      i_begin = i_child_end;
+    }
+    louds_.push(false);
+  }
+
+  louds_.build();
+  terminals_.build();
+  tails_.build();
+  results_.assign(node_results);
+  tail_offsets_.assign(tail_offsets);
+}
+
+
+/* 子からLabelが一致するNodeを探す                            */
+/* Node i の子はi+1番目の0の次から並ぶ1で、                   */
+/* 最初の子の番号はそれより前の1の数なので select0 から求まる */
+/* @param i_node  親Node                                      */
+/* @param c_label Label                                       */
+/* @return 子Node  0 : 無し                                   */
+uint64_t LoudsTrie::getChild(
+  const uint64_t i_node,
+  const char c_label) const noexcept
+{
+  const uint64_t i_begin(louds_.select0(i_node) + 1);
+  const uint64_t i_end(louds_.findNext0(i_begin));
+  const uint64_t i_first_child(i_begin - i_node - 1);
+
+  /* 子のLabelは昇順に並んでいる */
+  const unsigned char* c_labels = reinterpret_cast<const unsigned char*>(c_labels_.data());
+  const unsigned char* c_found  = lower_bound(c_labels + i_first_child, c_labels + i_first_child + (i_end - i_begin),
+                                              static_cast<unsigned char>(c_label));
+  if ((c_found == c_labels + i_first_child + (i_end - i_begin)) || (*c_found != static_cast<unsigned char>(c_label)))
+    return 0;
+
+  return c_found - c_labels;
+}
+
+
+/* NodeのTailとc_byteの先頭との一致長を求める */
+/* @param i_node        Tailを持つNode        */
+/* @param c_byte        search bytes          */
+/* @param i_byte_length search data length    */
+/* @return Tail長  -1 : Tail全体が一致しない  */
+int64_t LoudsTrie::matchTail(
+  const uint64_t i_node,
+  const char* c_byte,
+  const uint64_t i_byte_length) const noexcept
+{
+  const char* c_tail = &c_tail_[tail_offsets_.get(tails_.rank1(i_node))];
+  uint64_t i(0);
+  for (; c_tail[i] != DoubleArray::C_TAIL_CHAR; ++i) {
+    if ((i >= i_byte_length) || (c_tail[i] != c_byte[i]))
+      return -1;
+  }
+
+  return static_cast<int64_t>(i);
+}
@@ -0,0 +1,328 @@
+#ifndef LOUDSTRIE_H
+#define LOUDSTRIE_H
+
+/**
+ * LoudsTrie<br/>
+ * Trieの形をLOUDS(Level-Order Unary Degree Sequence)のbit列で表す。<br/>
+ * Nodeは幅優先順に番号を振り、Node毎に子の数だけ1を並べて0で区切る。<br/>
+ * 子は連番になるので、Labelは番号順の配列に持てばよく、<br/>
+ * 1Nodeあたりおよそ2bit+Label 1byte+終端・Tail 2bitで済む。<br/>
+ * DoubleArrayと同様に、1データだけが通る末尾はNodeにせずTailにまとめる。<br/>
+ * DoubleArrayより検索は遅いが、めったに検索しない辞書のメモリを大きく減らせる。<br/>
+ * 構築後の追加削除はできない
+ *
+ * @brief LOUDS Trie
+ * @file LoudsTrie.h
+ */
+
+#include "DoubleArray.h"
+
+class DABitVector;
+class DAPackedArray;
+class LoudsTrie;
+
+/** rank/selectを備えたbit列 */
+class DABitVector
+{
+public:
+  static constexpr uint64_t I_BLOCK_BITS    = 512;  /* rankを記録する間隔     */
+  static constexpr uint64_t I_BLOCK_WORDS   = 8;    /* Block内のword数        */
+  static constexpr uint64_t I_SELECT_SAMPLE = 512;  /* select用に記録する間隔 */
+
+public:
+  /** zero clear */
+  DABitVector() noexcept : i_size_(0) {}
+
+  /** 空にする */
+  void clear() noexcept;
+
+  /** 末尾にbitを追加する
+  * @param b_bit 追加するbit
+  */
+  void push(
+    const bool b_bit)
+  {
+    if ((i_size_ % 64) == 0)
+      i_words_.push_back(0);
+    if (b_bit)
+      i_words_.back() |= 1ULL << (i_size_ % 64);
+    ++i_size_;
+  }
+
+  /** 追加し終えたらrank/selectの索引を作る */
+  void build();
+
+  /** bitを取得する
+  * @param i_position 位置
+  * @return bit
+  */
+  bool get(
+    const uint64_t i_position) const noexcept
+  {
+    return (i_words_[i_position / 64] >> (i_position % 64)) & 1;
+  }
+
+  /** [0, i_position)の1の数を求める
+  * @param i_position 位置
+  * @return 1の数
+  */
+  uint64_t rank1(
+    const uint64_t i_position) const noexcept;
+
+  /** i_count番目(0始まり)の0の位置を求める
+  * @param i_count 0の順位
+  * @return 位置
+  */
+  uint64_t select0(
+    const uint64_t i_count) const noexcept;
+
+  /** i_position以降で最初の0の位置を求める
+  * @param i_position 位置
+  * @return 位置
+  */
+  uint64_t findNext0(
+    uint64_t i_position) const noexcept;
+
+  /** bit数 */
+  uint64_t getSize() const noexcept { return i_size_; }
+
+  /** 使用メモリのバイトサイズ */
+  uint64_t getMemorySize() const noexcept
+  {
+    return sizeof(i_words_[0]) * (i_words_.size() + i_ranks_.size() + i_select_samples_.size());
+  }
+
+  /** ファイルに書き込む
+  * @param i_write_size 書き込んだデータサイズ
+  * @param fp           OutputFileStream
+  * @return I_NO_ERROR : 正常終了 0以外 : 異常終了
+  */
+  int writeBinary(
+    int64_t& i_write_size,
+    FILE* fp) const noexcept;
+
+  /** ファイルから読み込む 索引は作り直す
+  * @param i_read_size 読み込んだデータサイズ
+  * @param fp          InputFileStream
+  * @return I_NO_ERROR : 正常終了 0以外 : 異常終了
+  */
+  int readBinary(
+    int64_t& i_read_size,
+    FILE* fp) noexcept;
+
+private:
+  /** bit列 */
+  std::vector<uint64_t> i_words_;
+
+  /** Block毎のそれより前の1の数 末尾に全体の数を持つ */
+  std::vector<uint64_t> i_ranks_;
+
+  /** I_SELECT_SAMPLE個毎の0を含むBlock番号 */
+  std::vector<uint64_t> i_select_samples_;
+
+  /** bit数 */
+  uint64_t i_size_;
+};
+
+/** 最小値との差を必要なbit幅だけで詰めた整数配列 */
+class DAPackedArray
+{
+public:
+  /** zero clear */
+  DAPackedArray() noexcept : i_min_(0), i_bits_(0), i_size_(0) {}
+
+  /** 空にする */
+  void clear() noexcept;
+
+  /** 値を詰めて設定する
+  * @param values 設定する値
+  */
+  void assign(
+    const std::vector<int64_t>& values);
+
+  /** 値を取得する
+  * @param i_index 位置
+  * @return 値
+  */
+  int64_t get(
+    const uint64_t i_index) const noexcept
+  {
+    if (i_bits_ == 0)
+      return i_min_;
+
+    const uint64_t i_bit(i_index * i_bits_);
+    uint64_t i_value(i_words_[i_bit / 64] >> (i_bit % 64));
+    if ((i_bit % 64) + i_bits_ > 64)
+      i_value |= i_words_[i_bit / 64 + 1] << (64 - (i_bit % 64));
+    if (i_bits_ < 64)
+      i_value &= (1ULL << i_bits_) - 1;
+
+    return static_cast<int64_t>(static_cast<uint64_t>(i_min_) + i_value);
+  }
+
+  /** 要素数 */
+  uint64_t getSize() const noexcept { return i_size_; }
+
+  /** 使用メモリのバイトサイズ */
+  uint64_t getMemorySize() const noexcept { return sizeof(i_words_[0]) * i_words_.size(); }
+
+  /** ファイルに書き込む
+  * @param i_write_size 書き込んだデータサイズ
+  * @param fp           OutputFileStream
+  * @return I_NO_ERROR : 正常終了 0以外 : 異常終了
+  */
+  int writeBinary(
+    int64_t& i_write_size,
+    FILE* fp) const noexcept;
+
+  /** ファイルから読み込む
+  * @param i_read_size 読み込んだデータサイズ
+  * @param fp          InputFileStream
+  * @return I_NO_ERROR : 正常終了 0以外 : 異常終了
+  */
+  int readBinary(
+    int64_t& i_read_size,
+    FILE* fp) noexcept;
+
+private:
+  /** 詰めた値 2wordに跨る読み出し用に1word余分に持つ */
+  std::vector<uint64_t> i_words_;
+
+  /** 最小値 */
+  int64_t i_min_;
+
+  /** 1要素のbit幅 0 : 全て最小値 */
+  uint64_t i_bits_;
+
+  /** 要素数 */
+  uint64_t i_size_;
+};
+
+/** LOUDS表現のTrie */
+class LoudsTrie
+{
+public:
+  static constexpr uint64_t I_FILE_MAGIC   = 0x315344554f4c4244; /* Binary形式の識別子 "DBLOUDS1" */
+  static constexpr uint32_t I_FILE_VERSION = 1;                  /* Binary形式のVersion          */
+
+public:
+  /** 構築済みのDoubleArrayから変換する
+  * 全データを辞書順に列挙して幅優先で配置する。検索結果もそのまま引き継ぐ
+  * @param double_array 構築済みのDoubleArray
+  * @return I_NO_ERROR : 正常終了 0以外 : 異常終了
+  */
+  int createLoudsTrie(
+    const DoubleArray& double_array) noexcept;
+
+  /** 構築データから作成する 同一データは後のものを使う
+  * @param add_datas 構築データ
+  * @return I_NO_ERROR : 正常終了 0以外 : 異常終了
+  */
+  int createLoudsTrie(
+    ByteArrays& add_datas) noexcept;
+
+  /** 検索する DoubleArray::searchと同じ結果を返す
+  * @param c_byte        search bytes 終端記号を必要としない
+  * @param i_byte_length search data length
+  * @return search result
+  */
+  int64_t search(
+    const char* c_byte,
+    const uint64_t i_byte_length) const noexcept;
+
+  /** 共通接頭辞検索 c_byteの先頭に一致する全てのデータを一度の走査で求める
+  * @param c_byte        search bytes 終端記号を必要としない
+  * @param i_byte_length search data length
+  * @param results       一致したデータの検索結果と一致長 短い順
+  * @param i_max_results resultsに格納する最大数
+  * @return 一致したデータ数 i_max_resultsを超える場合もある
+  */
+  uint64_t commonPrefixSearch(
+    const char* c_byte,
+    const uint64_t i_byte_length,
+    DAPrefixResult* results,
+    const uint64_t i_max_results) const noexcept;
+
+  /** LoudsTrie情報を書き込む
+  * @param i_write_size 書き込んだデータサイズ
+  * @param fp           OutputFileStream
+  * @return I_NO_ERROR : 正常終了 0以外 : 異常終了
+  */
+  int writeBinary(
+    int64_t& i_write_size,
+    FILE* fp) const noexcept;
+
+  /** LoudsTrie情報を読み込む
+  * @param i_read_size 読み込んだデータサイズ
+  * @param fp          InputFileStream
+  * @return I_NO_ERROR : 正常終了 0以外 : 異常終了
+  */
+  int readBinary(
+    int64_t& i_read_size,
+    FILE* fp) noexcept;
+
+  /** データが作成されているかチェック */
+  bool checkInit() const noexcept { return !c_labels_.empty(); }
+
+  /** Node数 */
+  uint64_t getNodeCount() const noexcept { return c_labels_.size(); }
+
+  /** 検索に使うメモリのバイトサイズ */
+  uint64_t getMemorySize() const noexcept;
+
+  /** 空にする */
+  void clear() noexcept;
+
+private:
+  /** 辞書順に並んだ一意のデータから幅優先でNodeを配置する
+  * @param keys    データ
+  * @param results 検索結果
+  */
+  void createLouds(
+    const std::vector<std::string>& keys,
+    const std::vector<int64_t>& results);
+
+  /** 子からLabelが一致するNodeを探す
+  * @param i_node  親Node
+  * @param c_label Label
+  * @return 子Node  0 : 無し(Rootは子にならない)
+  */
+  uint64_t getChild(
+    const uint64_t i_node,
+    const char c_label) const noexcept;
+
+  /** NodeのTailとc_byteの先頭との一致長を求める
+  * @param i_node        Tailを持つNode
+  * @param c_byte        search bytes
+  * @param i_byte_length search data length
+  * @return Tail全体が一致した場合はTail長  一致しなければ-1
+  */
+  int64_t matchTail(
+    const uint64_t i_node,
+    const char* c_byte,
+    const uint64_t i_byte_length) const noexcept;
+
+private:
+  /** LOUDS bit列 先頭に仮想RootのNode "10" を持つ */
+  DABitVector louds_;
+
+  /** Nodeでデータが終わるかどうか TailのNodeはTailの末尾で終わる */
+  DABitVector terminals_;
+
+  /** NodeがTailを持つかどうか */
+  DABitVector tails_;
+
+  /** Nodeへ遷移するLabel Node番号順 */
+  std::vector<char> c_labels_;
+
+  /** 検索結果 終端Node順 */
+  DAPackedArray results_;
+
+  /** Tail文字配列 各Tailは終端記号で終わる */
+  std::vector<char> c_tail_;
+
+  /** Tailの開始位置 TailのNode順 */
+  DAPackedArray tail_offsets_;
+};
+
+#endif
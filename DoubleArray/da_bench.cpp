@@ -0,0 +1,487 @@
+#include "DoubleArray.h"
+#include "LoudsTrie.h"
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <random>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+#include <cmath>
+
+/**
+ * DoubleArrayの性能計測<br/>
+ * 乱数の種を固定した合成データで構築と検索を分けて計測し、<br/>
+ * std::map/std::unordered_mapと比較する。<br/>
+ * usage : da_bench [key_count] [query_count] [seed]
+ */
+
+using namespace std;
+
+static constexpr uint64_t I_DEFAULT_KEY_COUNT   = 200000;   /* 登録するKey数           */
+static constexpr uint64_t I_DEFAULT_QUERY_COUNT = 1000000;  /* 1回の検索計測のQuery数  */
+static constexpr uint64_t I_DEFAULT_SEED        = 20180114; /* 乱数の種                */
+static constexpr uint64_t I_SAMPLE_BATCH        = 16;       /* 時間を測る単位のQuery数 */
+static constexpr double   D_ZIPF_EXPONENT       = 1.0;      /* Zipf分布の指数          */
+
+typedef chrono::steady_clock BenchClock;
+
+/** Key生成関数 重複は呼び出し側で除く */
+typedef function<void(string& key, mt19937_64& mt)> KeyGenerator;
+
+/** 計測対象のデータセット */
+class BenchDataSet
+{
+public:
+  /** データセット名 */
+  string s_name_;
+
+  /** 登録するKey 結果はIndex+1 */
+  vector<string> keys_;
+
+  /** 登録しないKey 同じ分布から生成 */
+  vector<string> miss_keys_;
+
+  /** true : 検索をZipf分布で偏らせる  false : 一様 */
+  bool b_zipf_;
+};
+
+/** 検索Query */
+class BenchQuery
+{
+public:
+  /** 検索するKey */
+  const string* key_;
+
+  /** 期待する検索結果 */
+  int64_t i_expected_;
+};
+
+/** 1回の検索計測の結果 */
+class LookupResult
+{
+public:
+  /** 1Queryあたりのns 各Batchの値を昇順に並べたもの */
+  vector<double> d_ns_per_lookups_;
+
+  /** 全Queryの所要時間 */
+  double d_total_sec_;
+
+  /** 期待と異なった件数 */
+  uint64_t i_errors_;
+};
+
+static void createKeys(BenchDataSet& data_set, const KeyGenerator& generator, const uint64_t i_key_count, mt19937_64& mt);
+static void createNumericKey(string& key, mt19937_64& mt);
+static void createUrlKey(string& key, mt19937_64& mt);
+static void createWordKey(string& key, mt19937_64& mt);
+static void createBinaryKey(string& key, mt19937_64& mt);
+static void createQueries(vector<BenchQuery>& queries, const BenchDataSet& data_set, const uint64_t i_query_count, const int i_miss_percent, mt19937_64& mt);
+static void printBuild(const char* c_name, const double d_build_sec, const uint64_t i_key_count, const uint64_t i_memory_size);
+static void printLookup(const char* c_name, const int i_miss_percent, const LookupResult& lookup_result);
+static void benchDataSet(const BenchDataSet& data_set, const uint64_t i_query_count, const uint64_t i_seed);
+
+int main(int argc, char* argv[])
+{
+  const uint64_t i_key_count(  argc > 1 ? strtoull(argv[1], nullptr, 10) : I_DEFAULT_KEY_COUNT);
+  const uint64_t i_query_count(argc > 2 ? strtoull(argv[2], nullptr, 10) : I_DEFAULT_QUERY_COUNT);
+  const uint64_t i_seed(       argc > 3 ? strtoull(argv[3], nullptr, 10) : I_DEFAULT_SEED);
+  if ((i_key_count == 0) || (i_query_count == 0)) {
+    fprintf(stderr, "usage : %s [key_count] [query_count] [seed]\n", argv[0]);
+    return 1;
+  }
+
+  printf("keys = %llu  queries = %llu  seed = %llu\n",
+         static_cast<unsigned long long>(i_key_count),
+         static_cast<unsigned long long>(i_query_count),
+         static_cast<unsigned long long>(i_seed));
+
+  const vector<pair<const char*, KeyGenerator>> generators = {
+    {"numeric", createNumericKey},
+    {"url",     createUrlKey},
+    {"zipf",    createWordKey},
+    {"binary",  createBinaryKey}};
+
+  for (const auto& generator : generators) {
+    mt19937_64 mt(i_seed);
+    BenchDataSet data_set;
+    data_set.s_name_ = generator.first;
+    data_set.b_zipf_ = (data_set.s_name_ == "zipf");
+    createKeys(data_set, generator.second, i_key_count, mt);
+    benchDataSet(data_set, i_query_count, i_seed);
+  }
+
+  return 0;
+}
+
+/* 重複しないKeyを登録用と未登録用に生成する */
+static void createKeys(
+  BenchDataSet& data_set,
+  const KeyGenerator& generator,
+  const uint64_t i_key_count,
+  mt19937_64& mt)
+{
+  unordered_set<string> created;
+  string key;
+  while (created.size() < i_key_count * 2) {
+    generator(key, mt);
+    if (key.empty() || !created.insert(key).second)
+      continue;
+
+    if (data_set.keys_.size() < i_key_count && (mt() & 1))
+      data_set.keys_.push_back(key);
+    else if (data_set.miss_keys_.size() < i_key_count)
+      data_set.miss_keys_.push_back(key);
+    else
+      data_set.keys_.push_back(key);
+  }
+}
+
+/* 10進数の数字列 桁数は1~15で一様 */
+static void createNumericKey(
+  string& key,
+  mt19937_64& mt)
+{
+  const uint64_t i_digits(mt() % 15 + 1);
+  key.clear();
+  for (uint64_t i = 0; i < i_digits; ++i) {
+    key.push_back(static_cast<char>('0' + mt() % 10));
+  }
+}
+
+/* 音節をつないだ単語 短い単語ほど多い */
+static void appendWord(
+  string& key,
+  mt19937_64& mt)
+{
+  static const char* const c_syllables[] = {
+    "a", "ka", "sa", "ta", "na", "ha", "ma", "ya", "ra", "wa", "i", "ki", "shi", "chi", "ni", "mi", "ri",
+    "u", "ku", "su", "tsu", "nu", "fu", "mu", "yu", "ru", "e", "ke", "se", "te", "ne", "me", "re",
+    "o", "ko", "so", "to", "no", "ho", "mo", "yo", "ro", "n", "ga", "da", "ba", "po", "zu"};
+  static constexpr uint64_t I_SYLLABLE_COUNT = sizeof(c_syllables) / sizeof(c_syllables[0]);
+
+  uint64_t i_syllables(1);
+  while ((i_syllables < 8) && (mt() % 3 != 0)) {
+    ++i_syllables;
+  }
+  for (uint64_t i = 0; i < i_syllables; ++i) {
+    key += c_syllables[mt() % I_SYLLABLE_COUNT];
+  }
+}
+
+/* URL風の文字列 共通の接頭辞を多く持つ */
+static void createUrlKey(
+  string& key,
+  mt19937_64& mt)
+{
+  static const char* const c_schemes[] = {"http://", "https://", "https://www."};
+  static const char* const c_domains[] = {".com", ".org", ".net", ".co.jp", ".io"};
+
+  key = c_schemes[mt() % 3];
+  appendWord(key, mt);
+  key += c_domains[mt() % 5];
+
+  const uint64_t i_depth(mt() % 4);
+  for (uint64_t i = 0; i < i_depth; ++i) {
+    key.push_back('/');
+    appendWord(key, mt);
+  }
+  if (mt() % 4 == 0) {
+    key += "?id=" + to_string(mt() % 100000);
+  }
+}
+
+/* 自然言語風の単語 検索はZipf分布で偏らせる */
+static void createWordKey(
+  string& key,
+  mt19937_64& mt)
+{
+  key.clear();
+  appendWord(key, mt);
+}
+
+/* 長いバイナリ列 64~256Byte TAILの終端記号と重なる0x00は含めない */
+static void createBinaryKey(
+  string& key,
+  mt19937_64& mt)
+{
+  const uint64_t i_length(64 + mt() % 193);
+  key.resize(i_length);
+  for (uint64_t i = 0; i < i_length; ++i) {
+    key[i] = static_cast<char>(mt() % 255 + 1);
+  }
+}
+
+/* 指定の割合で未登録Keyを混ぜたQueryを作る */
+/* 登録Keyは一様 もしくはZipf分布で選ぶ     */
+static void createQueries(
+  vector<BenchQuery>& queries,
+  const BenchDataSet& data_set,
+  const uint64_t i_query_count,
+  const int i_miss_percent,
+  mt19937_64& mt)
+{
+  vector<double> d_cumulatives;
+  if (data_set.b_zipf_) {
+    double d_sum(0.0);
+    for (uint64_t i = 0; i < data_set.keys_.size(); ++i) {
+      d_sum += 1.0 / pow(static_cast<double>(i + 1), D_ZIPF_EXPONENT);
+      d_cumulatives.push_back(d_sum);
+    }
+  }
+
+  queries.resize(i_query_count);
+  uniform_real_distribution<double> uniform(0.0, 1.0);
+  for (auto& query : queries) {
+    if (static_cast<int>(mt() % 100) < i_miss_percent) {
+      query.key_        = &data_set.miss_keys_[mt() % data_set.miss_keys_.size()];
+      query.i_expected_ = DoubleArray::I_SEARCH_NOHIT;
+      continue;
+    }
+
+    uint64_t i_index;
+    if (data_set.b_zipf_) {
+      const double d_point(uniform(mt) * d_cumulatives.back());
+      i_index = lower_bound(d_cumulatives.begin(), d_cumulatives.end(), d_point) - d_cumulatives.begin();
+      i_index = min<uint64_t>(i_index, data_set.keys_.size() - 1);
+    } else {
+      i_index = mt() % data_set.keys_.size();
+    }
+    query.key_        = &data_set.keys_[i_index];
+    query.i_expected_ = static_cast<int64_t>(i_index + 1);
+  }
+}
+
+/* I_SAMPLE_BATCH件ずつ時間を測りながら検索する    */
+/* 結果の照合は計測の外で行う                      */
+/* 1回目は暖機として捨て、2回目の値を結果とする    */
+template<class SearchFunction>
+static void measureLookups(
+  LookupResult& lookup_result,
+  const vector<BenchQuery>& queries,
+  const SearchFunction& search_function)
+{
+  vector<int64_t> results(queries.size());
+  for (int i_pass = 0; i_pass < 2; ++i_pass) {
+    lookup_result.d_ns_per_lookups_.clear();
+    const auto all_start = BenchClock::now();
+    for (uint64_t i_begin = 0; i_begin < queries.size(); i_begin += I_SAMPLE_BATCH) {
+      const uint64_t i_end(min<uint64_t>(i_begin + I_SAMPLE_BATCH, queries.size()));
+      const auto batch_start = BenchClock::now();
+      search_function(results.data() + i_begin, queries.data() + i_begin, i_end - i_begin);
+      const auto batch_time = BenchClock::now() - batch_start;
+      lookup_result.d_ns_per_lookups_.push_back(
+        static_cast<double>(chrono::duration_cast<chrono::nanoseconds>(batch_time).count()) / (i_end - i_begin));
+    }
+    lookup_result.d_total_sec_ = chrono::duration<double>(BenchClock::now() - all_start).count();
+  }
+
+  sort(lookup_result.d_ns_per_lookups_.begin(), lookup_result.d_ns_per_lookups_.end());
+  lookup_result.i_errors_ = 0;
+  for (uint64_t i = 0; i < queries.size(); ++i) {
+    if (results[i] != queries[i].i_expected_)
+      ++lookup_result.i_errors_;
+  }
+}
+
+/* 構築結果を出力する */
+static void printBuild(
+  const char* c_name,
+  const double d_build_sec,
+  const uint64_t i_key_count,
+  const uint64_t i_memory_size)
+{
+  printf("  %-24s build %9.1f ms %11.0f keys/s  memory %12llu bytes %7.1f bytes/key\n",
+         c_name, d_build_sec * 1000.0, i_key_count / d_build_sec,
+         static_cast<unsigned long long>(i_memory_size), static_cast<double>(i_memory_size) / i_key_count);
+}
+
+/* 検索結果を出力する 百分位はBatch単位の1Queryあたりns */
+static void printLookup(
+  const char* c_name,
+  const int i_miss_percent,
+  const LookupResult& lookup_result)
+{
+  const vector<double>& d_samples(lookup_result.d_ns_per_lookups_);
+  auto percentile = [&d_samples] (const double d_rate) {
+    return d_samples[min<uint64_t>(static_cast<uint64_t>(d_rate * d_samples.size()), d_samples.size() - 1)];};
+  const uint64_t i_query_count(d_samples.size() ? static_cast<uint64_t>(d_samples.size()) * I_SAMPLE_BATCH : 0);
+
+  printf("  %-24s miss %3d%%  p50 %7.1f  p90 %7.1f  p99 %7.1f  p99.9 %7.1f ns  %11.0f lookups/s%s\n",
+         c_name, i_miss_percent,
+         percentile(0.5), percentile(0.9), percentile(0.99), percentile(0.999),
+         i_query_count / lookup_result.d_total_sec_,
+         lookup_result.i_errors_ ? "  NG" : "");
+}
+
+/* std::mapの使用メモリ概算 Nodeのヘッダ+要素+長い文字列の確保領域 */
+static uint64_t estimateMapMemory(
+  const map<string, int64_t>& data_map)
+{
+  uint64_t i_size(sizeof(data_map));
+  for (const auto& data : data_map) {
+    i_size += 4 * sizeof(void*) + sizeof(data);
+    if (data.first.capacity() >= sizeof(string))
+      i_size += data.first.capacity() + 1;
+  }
+  return i_size;
+}
+
+/* std::unordered_mapの使用メモリ概算 Node+Hash値+長い文字列+Bucket配列 */
+static uint64_t estimateHashMapMemory(
+  const unordered_map<string, int64_t>& data_map)
+{
+  uint64_t i_size(sizeof(data_map) + data_map.bucket_count() * sizeof(void*));
+  for (const auto& data : data_map) {
+    i_size += sizeof(void*) + sizeof(data) + sizeof(size_t);
+    if (data.first.capacity() >= sizeof(string))
+      i_size += data.first.capacity() + 1;
+  }
+  return i_size;
+}
+
+/* 1つのデータセットで全ての構築・検索を計測する */
+static void benchDataSet(
+  const BenchDataSet& data_set,
+  const uint64_t i_query_count,
+  const uint64_t i_seed)
+{
+  uint64_t i_key_bytes(0);
+  for (const auto& key : data_set.keys_) {
+    i_key_bytes += key.size();
+  }
+  printf("-------- %s : %llu keys  average %.1f bytes --------\n",
+         data_set.s_name_.c_str(), static_cast<unsigned long long>(data_set.keys_.size()),
+         static_cast<double>(i_key_bytes) / data_set.keys_.size());
+
+  static const int i_miss_percents[] = {0, 50, 90};
+  vector<vector<BenchQuery>> query_sets;
+  for (const int i_miss_percent : i_miss_percents) {
+    mt19937_64 mt(i_seed + i_miss_percent);
+    query_sets.emplace_back();
+    createQueries(query_sets.back(), data_set, i_query_count, i_miss_percent, mt);
+  }
+
+  const uint64_t i_key_count(data_set.keys_.size());
+  LookupResult lookup_result;
+
+  /* DoubleArray 構築オプション毎 */
+  const vector<pair<const char*, int>> options = {
+    {"DoubleArray",          DoubleArray::I_NO_OPTION},
+    {"DoubleArray unit",     DoubleArray::I_UNIT_LAYOUT},
+    {"DoubleArray compact",  DoubleArray::I_UNIT_LAYOUT | DoubleArray::I_COMPACT_RESULT}};
+  for (const auto& option : options) {
+    const auto build_start = BenchClock::now();
+    ByteArrays byte_datas;
+    for (uint64_t i = 0; i < i_key_count; ++i) {
+      byte_datas.addData(data_set.keys_[i].c_str(), data_set.keys_[i].size(), static_cast<int64_t>(i + 1));
+    }
+    DoubleArray da;
+    if (da.createDoubleArray(byte_datas, option.second) != DoubleArray::I_NO_ERROR) {
+      printf("  %-24s build failed\n", option.first);
+      continue;
+    }
+    const double d_build_sec(chrono::duration<double>(BenchClock::now() - build_start).count());
+
+    int64_t i_image_size(0);
+    FILE* fp(tmpfile());
+    if (fp) {
+      da.writeBinary(i_image_size, fp);
+      fclose(fp);
+    }
+    printBuild(option.first, d_build_sec, i_key_count, static_cast<uint64_t>(i_image_size));
+
+    for (uint64_t i_set = 0; i_set < query_sets.size(); ++i_set) {
+      measureLookups(lookup_result, query_sets[i_set],
+        [&da] (int64_t* results, const BenchQuery* queries, const uint64_t i_count) {
+          for (uint64_t i = 0; i < i_count; ++i) {
+            results[i] = da.search(queries[i].key_->c_str(), queries[i].key_->size());
+          }});
+      printLookup(option.first, i_miss_percents[i_set], lookup_result);
+    }
+
+    if (option.second == DoubleArray::I_NO_OPTION) {
+      for (uint64_t i_set = 0; i_set < query_sets.size(); ++i_set) {
+        measureLookups(lookup_result, query_sets[i_set],
+          [&da] (int64_t* results, const BenchQuery* queries, const uint64_t i_count) {
+            const char* c_bytes[I_SAMPLE_BATCH];
+            uint64_t i_byte_lengths[I_SAMPLE_BATCH];
+            for (uint64_t i = 0; i < i_count; ++i) {
+              c_bytes[i]        = queries[i].key_->c_str();
+              i_byte_lengths[i] = queries[i].key_->size();
+            }
+            da.searchBatch(c_bytes, i_byte_lengths, i_count, results);});
+        printLookup("DoubleArray batch", i_miss_percents[i_set], lookup_result);
+      }
+    }
+  }
+
+  /* LoudsTrie 構築データからDoubleArrayを経由して変換する */
+  {
+    const auto build_start = BenchClock::now();
+    ByteArrays byte_datas;
+    for (uint64_t i = 0; i < i_key_count; ++i) {
+      byte_datas.addData(data_set.keys_[i].c_str(), data_set.keys_[i].size(), static_cast<int64_t>(i + 1));
+    }
+    LoudsTrie louds_trie;
+    if (louds_trie.createLoudsTrie(byte_datas) != DoubleArray::I_NO_ERROR) {
+      printf("  %-24s build failed\n", "LoudsTrie");
+    } else {
+      const double d_build_sec(chrono::duration<double>(BenchClock::now() - build_start).count());
+      printBuild("LoudsTrie", d_build_sec, i_key_count, louds_trie.getMemorySize());
+
+      for (uint64_t i_set = 0; i_set < query_sets.size(); ++i_set) {
+        measureLookups(lookup_result, query_sets[i_set],
+          [&louds_trie] (int64_t* results, const BenchQuery* queries, const uint64_t i_count) {
+            for (uint64_t i = 0; i < i_count; ++i) {
+              results[i] = louds_trie.search(queries[i].key_->c_str(), queries[i].key_->size());
+            }});
+        printLookup("LoudsTrie", i_miss_percents[i_set], lookup_result);
+      }
+    }
+  }
+
+  /* std::map */
+  {
+    const auto build_start = BenchClock::now();
+    map<string, int64_t> data_map;
+    for (uint64_t i = 0; i < i_key_count; ++i) {
+      data_map.emplace(data_set.keys_[i], static_cast<int64_t>(i + 1));
+    }
+    const double d_build_sec(chrono::duration<double>(BenchClock::now() - build_start).count());
+    printBuild("map (estimate)", d_build_sec, i_key_count, estimateMapMemory(data_map));
+
+    for (uint64_t i_set = 0; i_set < query_sets.size(); ++i_set) {
+      measureLookups(lookup_result, query_sets[i_set],
+        [&data_map] (int64_t* results, const BenchQuery* queries, const uint64_t i_count) {
+          for (uint64_t i = 0; i < i_count; ++i) {
+            const auto data = data_map.find(*queries[i].key_);
+            results[i] = (data != data_map.end()) ? data->second : DoubleArray::I_SEARCH_NOHIT;
+          }});
+      printLookup("map", i_miss_percents[i_set], lookup_result);
+    }
+  }
+
+  /* std::unordered_map */
+  {
+    const auto build_start = BenchClock::now();
+    unordered_map<string, int64_t> data_map;
+    for (uint64_t i = 0; i < i_key_count; ++i) {
+      data_map.emplace(data_set.keys_[i], static_cast<int64_t>(i + 1));
+    }
+    const double d_build_sec(chrono::duration<double>(BenchClock::now() - build_start).count());
+    printBuild("unordered_map (estimate)", d_build_sec, i_key_count, estimateHashMapMemory(data_map));
+
+    for (uint64_t i_set = 0; i_set < query_sets.size(); ++i_set) {
+      measureLookups(lookup_result, query_sets[i_set],
+        [&data_map] (int64_t* results, const BenchQuery* queries, const uint64_t i_count) {
+          for (uint64_t i = 0; i < i_count; ++i) {
+            const auto data = data_map.find(*queries[i].key_);
+            results[i] = (data != data_map.end()) ? data->second : DoubleArray::I_SEARCH_NOHIT;
+          }});
+      printLookup("unordered_map", i_miss_percents[i_set], lookup_result);
+    }
+  }
+}